@@ -0,0 +1,82 @@
+#ifndef FORTUNE_ARENA_H
+#define FORTUNE_ARENA_H
+
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+// Block allocator for the nodes of one diagram.
+//
+// Objects are carved out of large blocks in allocation order, so nodes made
+// one after another sit next to each other in memory. Single objects may be
+// handed back with release() and are reused by the next make(); everything
+// else is dropped at once by clear(), which keeps the blocks for the next
+// diagram. Destructors are never run, so T must be trivially destructible.
+template <class T>
+class Arena {
+    static_assert(std::is_trivially_destructible<T>::value,
+                  "Arena never runs destructors");
+
+public:
+    explicit Arena(std::size_t blockSize = 4096)
+            : blockSize(blockSize ? blockSize : 1), block(0), used(0), freeList(nullptr) {}
+
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    template <class... Args>
+    T *make(Args &&... args) {
+        Slot *s = freeList;
+        if (s) {
+            freeList = s->nextFree;
+        } else {
+            if (used == blockSize) {
+                ++block;
+                used = 0;
+            }
+            if (block == blocks.size())
+                blocks.emplace_back(new Slot[blockSize]);
+            s = &blocks[block][used++];
+        }
+        return ::new (static_cast<void *>(s->bytes)) T(std::forward<Args>(args)...);
+    }
+
+    // Hand a single object back for reuse before the next clear().
+    void release(T *p) {
+        Slot *s = reinterpret_cast<Slot *>(p);
+        s->nextFree = freeList;
+        freeList = s;
+    }
+
+    // Invalidate every object handed out, keeping the memory for reuse.
+    void clear() {
+        block = 0;
+        used = 0;
+        freeList = nullptr;
+    }
+
+    // Give the memory back to the system as well.
+    void shrink() {
+        clear();
+        blocks.clear();
+    }
+
+private:
+    union Slot {
+        Slot *nextFree;
+        alignas(T) unsigned char bytes[sizeof(T)];
+    };
+
+    std::size_t blockSize;
+    std::vector<std::unique_ptr<Slot[]>> blocks;
+    std::size_t block, used;   // Current block and the slots taken from it.
+    Slot *freeList;
+};
+
+
+#endif //FORTUNE_ARENA_H
@@ -0,0 +1,125 @@
+#ifndef FORTUNE_BATCHBUILDER_H
+#define FORTUNE_BATCHBUILDER_H
+
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "ThreadPool.h"
+#include "VoronoiBuilder.h"
+
+
+// Builds many small diagrams per call.
+//
+// The sites of all diagrams come in one flat array, diagram d owning
+// sites[offsets[d] .. offsets[d + 1]), and the segments go out the same way.
+// Each worker thread keeps its own VoronoiBuilder, so node storage, queues
+// and site buffers are reused from one diagram, and one call, to the next.
+//
+// Work is shared by stealing: the diagrams are dealt out in equal ranges, one
+// per worker, and a worker that runs out takes chunks from the others.
+class BatchBuilder {
+public:
+    typedef VoronoiBuilder::Point Point;
+    typedef VoronoiBuilder::Seg Seg;
+    typedef VoronoiBuilder::BoundingBox BoundingBox;
+
+    explicit BatchBuilder(unsigned threads = std::thread::hardware_concurrency())
+            : pool(threads), workers(pool.size()) {}
+
+    // Diagram d has sites[offsets[d] .. offsets[d + 1]); `offsets` holds
+    // diagrams + 1 entries.
+    void build(const std::vector<Point> &sites, const std::vector<std::size_t> &offsets) {
+        build(sites.data(), offsets.data(), offsets.empty() ? 0 : offsets.size() - 1);
+    }
+
+    void build(const Point *sites, const std::size_t *offsets, std::size_t diagrams) {
+        boxes.resize(diagrams);
+        counts.assign(diagrams, 0);
+
+        std::size_t n = workers.size();
+        for (std::size_t w = 0; w < n; ++w) {
+            workers[w].segs.clear();
+            workers[w].done.clear();
+            workers[w].next = diagrams * w / n;
+            workers[w].end = diagrams * (w + 1) / n;
+        }
+        for (std::size_t w = 0; w < n; ++w)
+            pool.submit([=] { work(w, sites, offsets); });
+        pool.wait();
+
+        // Lay the segments out by diagram.
+        segmentOffsets_.resize(diagrams + 1);
+        segmentOffsets_[0] = 0;
+        for (std::size_t d = 0; d < diagrams; ++d)
+            segmentOffsets_[d + 1] = segmentOffsets_[d] + counts[d];
+        segments_.assign(segmentOffsets_[diagrams], Seg(Point(0, 0), -1, -1));
+        for (std::size_t w = 0; w < n; ++w)
+            pool.submit([=] {
+                const Worker &k = workers[w];
+                for (const Done &d : k.done)
+                    std::copy(k.segs.begin() + d.first, k.segs.begin() + d.first + counts[d.diagram],
+                              segments_.begin() + segmentOffsets_[d.diagram]);
+            });
+        pool.wait();
+    }
+
+    // Diagram d has segments()[segmentOffsets()[d] .. segmentOffsets()[d + 1]),
+    // with left and right indexing its own sites.
+    const std::vector<Seg> &segments() const { return segments_; }
+    const std::vector<std::size_t> &segmentOffsets() const { return segmentOffsets_; }
+
+    const BoundingBox &bounds(std::size_t d) const { return boxes[d]; }
+
+private:
+    // Diagrams are taken this many at a time.
+    static constexpr std::size_t chunk = 16;
+
+    struct Done {
+        std::size_t diagram, first; // Its segments start at segs[first].
+    };
+
+    struct Worker {
+        VoronoiBuilder builder;
+        std::vector<Seg> segs;
+        std::vector<Done> done;
+
+        // Diagrams [next, end) are still to be taken from this worker.
+        std::atomic<std::size_t> next{0};
+        std::size_t end = 0;
+    };
+
+    ThreadPool pool;
+    std::vector<Worker> workers;
+    std::vector<BoundingBox> boxes;
+    std::vector<std::size_t> counts;
+    std::vector<Seg> segments_;
+    std::vector<std::size_t> segmentOffsets_;
+
+    void work(std::size_t self, const Point *sites, const std::size_t *offsets) {
+        Worker &me = workers[self];
+        std::size_t n = workers.size();
+
+        // Own range first, then the others', starting with the next worker.
+        for (std::size_t v = 0; v < n; ++v) {
+            Worker &victim = workers[(self + v) % n];
+            for (;;) {
+                std::size_t d = victim.next.fetch_add(chunk);
+                if (d >= victim.end) break;
+                for (std::size_t e = std::min(d + chunk, victim.end); d < e; ++d) {
+                    me.builder.build(sites + offsets[d], offsets[d + 1] - offsets[d]);
+                    me.done.push_back({d, me.segs.size()});
+                    for (const Seg *s : me.builder.segments()) me.segs.push_back(*s);
+                    counts[d] = me.builder.segments().size();
+                    boxes[d] = me.builder.bounds();
+                }
+            }
+        }
+    }
+};
+
+
+#endif //FORTUNE_BATCHBUILDER_H
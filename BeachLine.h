@@ -0,0 +1,279 @@
+#ifndef FORTUNE_BEACHLINE_H
+#define FORTUNE_BEACHLINE_H
+
+
+// Red-black tree over the arcs of the parabolic front.
+//
+// The tree is intrusive: a Node must provide `prev`, `next`, `parent`, `left`,
+// `right` (all Node*) and a `bool red`. The in-order sequence of the tree is
+// the order of the arcs along the front, and BeachLine keeps the `prev`/`next`
+// threading in step with it, so code that walks neighbouring arcs never has to
+// touch the tree links.
+//
+// The tree holds no keys. Breakpoints move with the sweep line, so searches are
+// driven by a caller supplied locator that looks at a node and its neighbours
+// at the current sweep position.
+
+template <class Node>
+class BeachLine {
+public:
+    BeachLine() : root_(nullptr), first_(nullptr), last_(nullptr) {}
+
+    bool empty() const { return root_ == nullptr; }
+    Node *root() const { return root_; }
+    Node *first() const { return first_; }
+    Node *last() const { return last_; }
+
+    void clear() { root_ = first_ = last_ = nullptr; }
+
+    // Descend from the root: `locate(n)` returns < 0 to go left, > 0 to go right
+    // and 0 when n is the wanted node. If rounding sends the descent off the
+    // tree, the last node visited is returned; null only for an empty tree.
+    template <class Locate>
+    Node *find(Locate locate) const {
+        Node *n = root_, *last = nullptr;
+        while (n) {
+            last = n;
+            int c = locate(n);
+            if (c < 0) n = n->left;
+            else if (c > 0) n = n->right;
+            else return n;
+        }
+        return last;
+    }
+
+    // Link n directly after pos (at the front of the line if pos is null).
+    void insertAfter(Node *pos, Node *n) {
+        if (!pos && first_) {
+            insertBefore(first_, n);
+            return;
+        }
+        reset(n);
+        if (!root_) {
+            n->prev = n->next = nullptr;
+            n->red = false;
+            root_ = first_ = last_ = n;
+            return;
+        }
+
+        n->prev = pos;
+        n->next = pos->next;
+        if (pos->next) pos->next->prev = n;
+        else last_ = n;
+        pos->next = n;
+
+        // The in-order successor of pos has no left child when pos has a right one.
+        if (!pos->right) attach(pos, n, false);
+        else attach(n->next, n, true);
+        insertFixup(n);
+    }
+
+    // Link n directly before pos (at the end of the line if pos is null).
+    void insertBefore(Node *pos, Node *n) {
+        if (!pos) {
+            insertAfter(last_, n);
+            return;
+        }
+        reset(n);
+
+        n->next = pos;
+        n->prev = pos->prev;
+        if (pos->prev) pos->prev->next = n;
+        else first_ = n;
+        pos->prev = n;
+
+        if (!pos->left) attach(pos, n, true);
+        else attach(n->prev, n, false);
+        insertFixup(n);
+    }
+
+    // Unlink z. z->prev and z->next are left pointing at its former neighbours.
+    void erase(Node *z) {
+        if (z->prev) z->prev->next = z->next;
+        else first_ = z->next;
+        if (z->next) z->next->prev = z->prev;
+        else last_ = z->prev;
+
+        Node *x, *xParent;
+        bool removedRed = z->red;
+
+        if (!z->left) {
+            x = z->right;
+            xParent = z->parent;
+            transplant(z, z->right);
+        } else if (!z->right) {
+            x = z->left;
+            xParent = z->parent;
+            transplant(z, z->left);
+        } else {
+            // z->next is the leftmost node of the right subtree.
+            Node *y = z->next;
+            removedRed = y->red;
+            x = y->right;
+            if (y->parent == z) {
+                xParent = y;
+            } else {
+                xParent = y->parent;
+                transplant(y, y->right);
+                y->right = z->right;
+                y->right->parent = y;
+            }
+            transplant(z, y);
+            y->left = z->left;
+            y->left->parent = y;
+            y->red = z->red;
+        }
+
+        if (!removedRed) eraseFixup(x, xParent);
+        z->parent = z->left = z->right = nullptr;
+    }
+
+private:
+    Node *root_;
+    Node *first_, *last_;
+
+    static bool isRed(const Node *n) { return n && n->red; }
+
+    static void reset(Node *n) {
+        n->parent = n->left = n->right = nullptr;
+        n->red = true;
+    }
+
+    static void attach(Node *parent, Node *n, bool asLeft) {
+        if (asLeft) parent->left = n;
+        else parent->right = n;
+        n->parent = parent;
+    }
+
+    void replaceChild(Node *parent, Node *oldChild, Node *newChild) {
+        if (!parent) root_ = newChild;
+        else if (parent->left == oldChild) parent->left = newChild;
+        else parent->right = newChild;
+    }
+
+    void transplant(Node *u, Node *v) {
+        replaceChild(u->parent, u, v);
+        if (v) v->parent = u->parent;
+    }
+
+    void rotateLeft(Node *x) {
+        Node *y = x->right;
+        x->right = y->left;
+        if (y->left) y->left->parent = x;
+        y->parent = x->parent;
+        replaceChild(x->parent, x, y);
+        y->left = x;
+        x->parent = y;
+    }
+
+    void rotateRight(Node *x) {
+        Node *y = x->left;
+        x->left = y->right;
+        if (y->right) y->right->parent = x;
+        y->parent = x->parent;
+        replaceChild(x->parent, x, y);
+        y->right = x;
+        x->parent = y;
+    }
+
+    void insertFixup(Node *n) {
+        while (n != root_ && n->parent->red) {
+            Node *p = n->parent, *g = p->parent;
+            if (p == g->left) {
+                Node *u = g->right;
+                if (isRed(u)) {
+                    p->red = u->red = false;
+                    g->red = true;
+                    n = g;
+                } else {
+                    if (n == p->right) {
+                        rotateLeft(p);
+                        n = p;
+                        p = n->parent;
+                    }
+                    p->red = false;
+                    g->red = true;
+                    rotateRight(g);
+                }
+            } else {
+                Node *u = g->left;
+                if (isRed(u)) {
+                    p->red = u->red = false;
+                    g->red = true;
+                    n = g;
+                } else {
+                    if (n == p->left) {
+                        rotateRight(p);
+                        n = p;
+                        p = n->parent;
+                    }
+                    p->red = false;
+                    g->red = true;
+                    rotateLeft(g);
+                }
+            }
+        }
+        root_->red = false;
+    }
+
+    // x (possibly null) carries an extra black; parent is its parent.
+    void eraseFixup(Node *x, Node *parent) {
+        while (x != root_ && !isRed(x)) {
+            if (x == parent->left) {
+                Node *w = parent->right;
+                if (isRed(w)) {
+                    w->red = false;
+                    parent->red = true;
+                    rotateLeft(parent);
+                    w = parent->right;
+                }
+                if (!isRed(w->left) && !isRed(w->right)) {
+                    w->red = true;
+                    x = parent;
+                    parent = x->parent;
+                } else {
+                    if (!isRed(w->right)) {
+                        w->left->red = false;
+                        w->red = true;
+                        rotateRight(w);
+                        w = parent->right;
+                    }
+                    w->red = parent->red;
+                    parent->red = false;
+                    if (w->right) w->right->red = false;
+                    rotateLeft(parent);
+                    x = root_;
+                }
+            } else {
+                Node *w = parent->left;
+                if (isRed(w)) {
+                    w->red = false;
+                    parent->red = true;
+                    rotateRight(parent);
+                    w = parent->left;
+                }
+                if (!isRed(w->left) && !isRed(w->right)) {
+                    w->red = true;
+                    x = parent;
+                    parent = x->parent;
+                } else {
+                    if (!isRed(w->left)) {
+                        w->right->red = false;
+                        w->red = true;
+                        rotateLeft(w);
+                        w = parent->left;
+                    }
+                    w->red = parent->red;
+                    parent->red = false;
+                    if (w->left) w->left->red = false;
+                    rotateRight(parent);
+                    x = root_;
+                }
+            }
+        }
+        if (x) x->red = false;
+    }
+};
+
+
+#endif //FORTUNE_BEACHLINE_H
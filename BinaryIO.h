@@ -0,0 +1,290 @@
+#ifndef FORTUNE_BINARYIO_H
+#define FORTUNE_BINARYIO_H
+
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "VoronoiBuilder.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+// Binary files for sites and segments.
+//
+// Both start with a FileHeader. A site file then holds `count` packed
+// (x, y) float64 pairs; a segment file holds the bounding box as four float64
+// (X0, X1, Y0, Y1) followed by `count` SegmentRecords. Values are stored in
+// the byte order of the machine that wrote them, and readers reject files
+// whose byteOrder mark does not match their own.
+struct FileHeader {
+    char magic[8];
+    std::uint32_t byteOrder;
+    std::uint32_t version;
+    std::uint64_t count;
+};
+
+struct SegmentRecord {
+    double x0, y0, x1, y1;
+    std::int32_t left, right; // Site indices, as in VoronoiBuilder::Seg.
+};
+
+static_assert(sizeof(FileHeader) == 24, "FileHeader must be packed");
+static_assert(sizeof(SegmentRecord) == 40, "SegmentRecord must be packed");
+
+
+class BinaryIO {
+public:
+    typedef VoronoiBuilder::Point Point;
+    typedef VoronoiBuilder::BoundingBox BoundingBox;
+
+    static constexpr char siteMagic[8] = {'F', 'O', 'R', 'T', 'S', 'I', 'T', 'E'};
+    static constexpr char segmentMagic[8] = {'F', 'O', 'R', 'T', 'S', 'E', 'G', 'S'};
+    static constexpr std::uint32_t byteOrderMark = 0x01020304;
+    static constexpr std::uint32_t version = 1;
+
+    static FileHeader header(const char (&magic)[8], std::uint64_t count) {
+        FileHeader h;
+        std::memcpy(h.magic, magic, sizeof h.magic);
+        h.byteOrder = byteOrderMark;
+        h.version = version;
+        h.count = count;
+        return h;
+    }
+
+    // Check h against the expected magic and the size of the data after it.
+    static void validate(const FileHeader &h, const char (&magic)[8],
+                         std::uint64_t available, std::size_t recordSize) {
+        if (std::memcmp(h.magic, magic, sizeof h.magic) != 0)
+            throw std::runtime_error("Not a " + std::string(magic, 8) + " file.");
+        if (h.byteOrder != byteOrderMark)
+            throw std::runtime_error("File was written with a different byte order.");
+        if (h.version != version)
+            throw std::runtime_error("Unsupported file version.");
+        if (h.count > available / recordSize)
+            throw std::runtime_error("File is shorter than its header says.");
+    }
+
+    static void writeSites(const std::string &path, const std::vector<Point> &sites) {
+        std::ofstream out(path, std::ios::binary);
+        if (!out) throw std::runtime_error("Cannot open " + path + " for writing.");
+
+        static_assert(sizeof(Point) == 2 * sizeof(double), "Point must be two packed doubles");
+        FileHeader h = header(siteMagic, sites.size());
+        out.write(reinterpret_cast<const char *>(&h), sizeof h);
+        out.write(reinterpret_cast<const char *>(sites.data()),
+                  static_cast<std::streamsize>(sites.size() * sizeof(Point)));
+        if (!out) throw std::runtime_error("Failed writing " + path + ".");
+    }
+
+    static void writeSegments(const std::string &path, const BoundingBox &box,
+                              const std::vector<VoronoiBuilder::Seg*> &segments);
+};
+
+
+// Read-only memory mapping of a whole file.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string &path) : data_(nullptr), size_(0) {
+#ifdef _WIN32
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                           OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            throw std::runtime_error("Cannot open " + path + ".");
+        LARGE_INTEGER size;
+        GetFileSizeEx(file, &size);
+        size_ = static_cast<std::size_t>(size.QuadPart);
+        mapping = size_ ? CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+        if (size_ && !mapping) {
+            CloseHandle(file);
+            throw std::runtime_error("Cannot map " + path + ".");
+        }
+        if (mapping) data_ = static_cast<const char *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+#else
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw std::runtime_error("Cannot open " + path + ".");
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            close(fd);
+            throw std::runtime_error("Cannot stat " + path + ".");
+        }
+        size_ = static_cast<std::size_t>(st.st_size);
+        if (size_) {
+            void *p = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED) {
+                close(fd);
+                throw std::runtime_error("Cannot map " + path + ".");
+            }
+            madvise(p, size_, MADV_SEQUENTIAL);
+            data_ = static_cast<const char *>(p);
+        }
+        close(fd);
+#endif
+    }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    ~MappedFile() {
+#ifdef _WIN32
+        if (data_) UnmapViewOfFile(data_);
+        if (mapping) CloseHandle(mapping);
+        CloseHandle(file);
+#else
+        if (data_) munmap(const_cast<char *>(data_), size_);
+#endif
+    }
+
+    const char *data() const { return data_; }
+    std::size_t size() const { return size_; }
+
+private:
+    const char *data_;
+    std::size_t size_;
+#ifdef _WIN32
+    HANDLE file, mapping;
+#endif
+};
+
+
+// A site file, mapped and used in place: the sites are never parsed or copied.
+class SiteFile {
+public:
+    typedef VoronoiBuilder::Point Point;
+
+    explicit SiteFile(const std::string &path) : file(path) {
+        if (file.size() < sizeof(FileHeader))
+            throw std::runtime_error(path + " is too short for a site file.");
+        std::memcpy(&h, file.data(), sizeof h);
+        BinaryIO::validate(h, BinaryIO::siteMagic, file.size() - sizeof h, 2 * sizeof(double));
+    }
+
+    std::size_t size() const { return static_cast<std::size_t>(h.count); }
+
+    // The packed (x, y) pairs, laid out exactly like an array of Point.
+    const Point *data() const {
+        return reinterpret_cast<const Point *>(file.data() + sizeof(FileHeader));
+    }
+
+private:
+    static_assert(sizeof(Point) == 2 * sizeof(double), "Point must be two packed doubles");
+
+    MappedFile file;
+    FileHeader h;
+};
+
+
+// A segment file, mapped and used in place.
+class SegmentFile {
+public:
+    typedef VoronoiBuilder::BoundingBox BoundingBox;
+
+    explicit SegmentFile(const std::string &path) : file(path) {
+        if (file.size() < sizeof(FileHeader) + sizeof(BoundingBox))
+            throw std::runtime_error(path + " is too short for a segment file.");
+        std::memcpy(&h, file.data(), sizeof h);
+        std::memcpy(&box, file.data() + sizeof h, sizeof box);
+        BinaryIO::validate(h, BinaryIO::segmentMagic,
+                           file.size() - sizeof h - sizeof box, sizeof(SegmentRecord));
+    }
+
+    const BoundingBox &bounds() const { return box; }
+    std::size_t size() const { return static_cast<std::size_t>(h.count); }
+
+    const SegmentRecord *data() const {
+        return reinterpret_cast<const SegmentRecord *>(file.data() + sizeof(FileHeader) + sizeof(BoundingBox));
+    }
+
+private:
+    MappedFile file;
+    FileHeader h;
+    BoundingBox box;
+};
+
+
+// Streams segments to a file.  Pass it to VoronoiBuilder::setSink as
+// std::ref(writer); the bounding box is only known once build() has started,
+// so it is given to setBounds() and, with the record count, written by close().
+class SegmentFileWriter {
+public:
+    typedef VoronoiBuilder::BoundingBox BoundingBox;
+    typedef VoronoiBuilder::Seg Seg;
+
+    explicit SegmentFileWriter(const std::string &path, std::size_t bufferRecords = 4096)
+            : path(path), out(path, std::ios::binary), box(), count(0) {
+        if (!out) throw std::runtime_error("Cannot open " + path + " for writing.");
+        FileHeader h = BinaryIO::header(BinaryIO::segmentMagic, 0);
+        out.write(reinterpret_cast<const char *>(&h), sizeof h);
+        out.write(reinterpret_cast<const char *>(&box), sizeof box);
+        buffer.reserve(bufferRecords ? bufferRecords : 1);
+    }
+
+    SegmentFileWriter(const SegmentFileWriter &) = delete;
+    SegmentFileWriter &operator=(const SegmentFileWriter &) = delete;
+
+    ~SegmentFileWriter() {
+        try {
+            close();
+        } catch (const std::exception &) {
+        }
+    }
+
+    void operator()(const Seg &s) {
+        buffer.push_back({s.start.first, s.start.second, s.end.first, s.end.second,
+                          s.left, s.right});
+        if (buffer.size() == buffer.capacity()) drain();
+    }
+
+    void setBounds(const BoundingBox &b) { box = b; }
+
+    void close() {
+        if (!out.is_open()) return;
+        drain();
+        out.seekp(offsetof(FileHeader, count));
+        std::uint64_t n = count;
+        out.write(reinterpret_cast<const char *>(&n), sizeof n);
+        out.write(reinterpret_cast<const char *>(&box), sizeof box);
+        out.close();
+        if (out.fail()) throw std::runtime_error("Failed writing " + path + ".");
+    }
+
+private:
+    std::string path;
+    std::ofstream out;
+    BoundingBox box;
+    std::uint64_t count;
+    std::vector<SegmentRecord> buffer;
+
+    void drain() {
+        out.write(reinterpret_cast<const char *>(buffer.data()),
+                  static_cast<std::streamsize>(buffer.size() * sizeof(SegmentRecord)));
+        count += buffer.size();
+        buffer.clear();
+    }
+};
+
+
+inline void BinaryIO::writeSegments(const std::string &path, const BoundingBox &box,
+                                    const std::vector<VoronoiBuilder::Seg*> &segments) {
+    SegmentFileWriter writer(path);
+    for (const VoronoiBuilder::Seg *s : segments) writer(*s);
+    writer.setBounds(box);
+    writer.close();
+}
+
+
+#endif //FORTUNE_BINARYIO_H
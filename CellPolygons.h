@@ -0,0 +1,197 @@
+#ifndef FORTUNE_CELLPOLYGONS_H
+#define FORTUNE_CELLPOLYGONS_H
+
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+#include "HalfEdgeDiagram.h"
+
+
+// The cells of a diagram as closed polygons, clipped to a convex region.
+//
+// Cells whose vertices all lie inside the region are copied from the
+// half-edges as they are.  The others, which include every unbounded cell,
+// are cut out of the region by the half-planes of their edges' bisectors, so
+// no far points are needed.  Both steps run over all vertices or all boundary
+// edges at once in flat arrays, which keeps the loops simple enough for the
+// compiler to vectorize.
+template <class T>
+class CellPolygons {
+public:
+    typedef std::pair<T, T> Point;
+
+    // The box [x0, x1] x [y0, y1] as a region.
+    static std::vector<Point> rectangle(T x0, T x1, T y0, T y1) {
+        return {Point(x0, y0), Point(x1, y0), Point(x1, y1), Point(x0, y1)};
+    }
+
+    struct Cell {
+        std::size_t begin, end; // Its corners in vertices(), counterclockwise.
+    };
+
+    // Cells of sites[0 .. n), which `d` was built from, clipped to `region`,
+    // a convex polygon given counterclockwise.
+    void build(const HalfEdgeDiagram<T> &d, const Point *sites, std::size_t n, const std::vector<Point> &region) {
+        vertices_.clear();
+        vertices_.reserve(d.face.size());
+        cells_.assign(n, Cell{0, 0});
+        clipFace.clear();
+        lineStart.assign(1, 0);
+        lineFace.clear();
+        lineOther.clear();
+        if (region.size() < 3) return;
+
+        findOutside(d, region);
+
+        // A single distinct site owns the whole region.
+        if (d.face.empty() && n > 0) clipLater(0);
+
+        // Copy the cells inside, and list the bisectors of the others.  The
+        // cells are taken in the order of their first half-edges, which is
+        // about the order of the sweep, so that the half-edges of one cell
+        // are near those of the last.
+        int halfEdges = static_cast<int>(d.face.size());
+        for (int h0 = 0; h0 < halfEdges; ++h0) {
+            std::size_t f = d.face[h0];
+            if (f >= n || d.faceEdge[f] != h0) continue;
+            Cell &cell = cells_[f];
+            cell.begin = vertices_.size();
+
+            bool inside = true;
+            int h = h0;
+            do {
+                int v = d.origin[h];
+                if (v < 0 || outside[v]) {
+                    inside = false;
+                    break;
+                }
+                // Edges of length zero join cocircular sites.
+                if (vertices_.size() == cell.begin || d.vertices[v] != vertices_.back())
+                    vertices_.push_back(d.vertices[v]);
+                h = d.next[h];
+            } while (h >= 0 && h != h0);
+
+            if (inside && h >= 0) {
+                if (vertices_.size() - cell.begin > 1 && vertices_.back() == vertices_[cell.begin])
+                    vertices_.pop_back();
+            } else {
+                vertices_.resize(cell.begin);
+                // A strip has a second chain of bisectors.
+                for (int first : {h0, d.stripEdge[f]}) {
+                    for (h = first; h >= 0;) {
+                        lineFace.push_back(static_cast<int>(f));
+                        lineOther.push_back(d.face[HalfEdgeDiagram<T>::twin(h)]);
+                        h = d.next[h];
+                        if (h == first) break;
+                    }
+                }
+                clipLater(f);
+            }
+            cell.end = vertices_.size();
+        }
+
+        findLines(sites);
+        for (std::size_t k = 0; k < clipFace.size(); ++k) {
+            Cell &cell = cells_[clipFace[k]];
+            cell.begin = vertices_.size();
+            clip(region, lineStart[k], lineStart[k + 1]);
+            cell.end = vertices_.size();
+        }
+    }
+
+    // By input index.  The cell of a duplicate swept under another index, or
+    // of a site whose cell misses the region, is empty.
+    const std::vector<Cell> &cells() const { return cells_; }
+    const std::vector<Point> &vertices() const { return vertices_; }
+
+private:
+    std::vector<Point> vertices_;
+    std::vector<Cell> cells_;
+
+    // Scratch, by vertex of the diagram.
+    std::vector<T> xs, ys;
+    std::vector<char> outside;
+
+    // Scratch, by cell to clip: its site, and where its lines start.
+    std::vector<int> clipFace;
+    std::vector<std::size_t> lineStart;
+
+    // Scratch, by line: the cell keeps the side where nx x + ny y <= c.
+    std::vector<int> lineFace, lineOther;
+    std::vector<T> nx, ny, c;
+
+    // Polygons being clipped, with the distances of their vertices.
+    std::vector<Point> poly, cut;
+    std::vector<T> dist;
+
+    void clipLater(std::size_t f) {
+        clipFace.push_back(static_cast<int>(f));
+        lineStart.push_back(lineFace.size());
+    }
+
+    // Which vertices of d lie outside the region.
+    void findOutside(const HalfEdgeDiagram<T> &d, const std::vector<Point> &region) {
+        std::size_t m = d.vertices.size();
+        xs.resize(m);
+        ys.resize(m);
+        outside.assign(m, 0);
+        for (std::size_t k = 0; k < m; ++k) {
+            xs[k] = d.vertices[k].first;
+            ys[k] = d.vertices[k].second;
+        }
+
+        const T *px = xs.data(), *py = ys.data();
+        char *out = outside.data();
+        for (std::size_t j = 0; j < region.size(); ++j) {
+            const Point &a = region[j], &b = region[(j + 1) % region.size()];
+            T ax = a.first, ay = a.second, ex = b.first - a.first, ey = b.second - a.second;
+            for (std::size_t k = 0; k < m; ++k)
+                out[k] |= ex * (py[k] - ay) - ey * (px[k] - ax) < 0;
+        }
+    }
+
+    // The bisector half-plane of each line's two sites, on the side of its
+    // own site.
+    void findLines(const Point *sites) {
+        std::size_t m = lineFace.size();
+        nx.resize(m);
+        ny.resize(m);
+        c.resize(m);
+        for (std::size_t k = 0; k < m; ++k) {
+            const Point &f = sites[lineFace[k]], &g = sites[lineOther[k]];
+            nx[k] = g.first - f.first;
+            ny[k] = g.second - f.second;
+            c[k] = (nx[k] * (f.first + g.first) + ny[k] * (f.second + g.second)) / 2;
+        }
+    }
+
+    // Cut `region` down by lines [first, last) and append the rest.
+    void clip(const std::vector<Point> &region, std::size_t first, std::size_t last) {
+        poly.assign(region.begin(), region.end());
+        for (std::size_t k = first; k < last && !poly.empty(); ++k) {
+            std::size_t m = poly.size();
+            dist.resize(m);
+            for (std::size_t i = 0; i < m; ++i)
+                dist[i] = nx[k] * poly[i].first + ny[k] * poly[i].second - c[k];
+
+            // Sutherland-Hodgman against one half-plane.
+            cut.clear();
+            for (std::size_t i = 0; i < m; ++i) {
+                std::size_t j = i + 1 == m ? 0 : i + 1;
+                T di = dist[i], dj = dist[j];
+                if (di <= 0) cut.push_back(poly[i]);
+                if ((di < 0 && dj > 0) || (di > 0 && dj < 0)) {
+                    T t = di / (di - dj);
+                    cut.emplace_back(poly[i].first + t * (poly[j].first - poly[i].first),
+                                     poly[i].second + t * (poly[j].second - poly[i].second));
+                }
+            }
+            poly.swap(cut);
+        }
+        if (poly.size() >= 3) vertices_.insert(vertices_.end(), poly.begin(), poly.end());
+    }
+};
+
+
+#endif //FORTUNE_CELLPOLYGONS_H
@@ -0,0 +1,678 @@
+#ifndef FORTUNE_DYNAMICVORONOI_H
+#define FORTUNE_DYNAMICVORONOI_H
+
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "Predicates.h"
+#include "VoronoiBuilder.h"
+
+
+// A diagram that takes single sites in and out without a new sweep.
+//
+// It is held as its dual, the Delaunay triangulation, which build() takes
+// from the sweep.  insert() replaces the triangles whose circumcircles hold
+// the new site by a fan around it (Bowyer-Watson).  remove() fills the star of
+// the site again with ears cut from the polygon of its neighbours, each one
+// checked to have no other neighbour in its circle.  Either touches only the
+// triangles of the cells that change.  A new site is found by walking from
+// the last change, or from a site the caller knows to be near, so an update
+// costs about the same at any number of sites.  Cells are read from the
+// triangles when asked for.
+//
+// Triangle t is the half-edges 3t, 3t + 1 and 3t + 2, counterclockwise, each
+// holding the site it starts from and the index of its twin.  Outside the
+// convex hull each hull edge has a ghost triangle with the vertex at
+// infinity, so a site beyond the hull goes in like any other.  While the
+// sites are fewer than three or all collinear there are no triangles at all,
+// and each change takes a new sweep until there are.
+//
+// Site ids are input indices after build(); insert() hands out the ids of
+// removed sites again before new ones.  The predicates are exact in double,
+// so T should be float or double.
+template <class T>
+class DynamicVoronoi {
+public:
+    typedef std::pair<T, T> Point;
+
+    // Type of the arithmetic on coordinates.
+    typedef typename std::common_type<T, double>::type Real;
+    typedef std::pair<Real, Real> RealPoint;
+
+    void build(const std::vector<Point> &sites) { build(sites.data(), sites.size()); }
+
+    // Start over with sites[0 .. n), site k as id k.  A site repeated in the
+    // input is kept once, under one of its ids.
+    void build(const Point *sites, std::size_t n) {
+        points.assign(sites, sites + n);
+        alive.assign(n, 1);
+        freeSites.clear();
+        liveCount = n;
+        triangulate();
+
+        if (!flat) {
+            // The sweep leaves repeated sites out of its triangles.
+            for (std::size_t s = 0; s < n; ++s)
+                if (edgeOf[s] < 0) release(static_cast<int>(s));
+            return;
+        }
+        std::vector<int> order;
+        for (std::size_t s = 0; s < n; ++s) order.push_back(static_cast<int>(s));
+        std::sort(order.begin(), order.end(), [this](int a, int b) { return points[a] < points[b]; });
+        for (std::size_t k = 1; k < order.size(); ++k)
+            if (points[order[k]] == points[order[k - 1]]) release(order[k]);
+    }
+
+    // Add a site at p and return its id, or -1 if there is a site at p
+    // already.  The search for p starts at site `near` if given, else at
+    // the nearest of the last change and a few sites drawn at random.
+    int insert(const Point &p, int near = -1) {
+        if (flat) {
+            if (occupied(p, -1)) return -1;
+            int s = claim(p);
+            if (liveCount >= 3) triangulate();
+            return s;
+        }
+        int t = locate(p, contains(near) ? edgeOf[near] : jump(p));
+        if (!conflict(t, p)) return -1;
+        int s = claim(p);
+        fan(s, t);
+        return s;
+    }
+
+    // Take out site s; false if there is no such site.
+    bool remove(int s) {
+        if (!contains(s)) return false;
+        if (!flat) unlink(s);
+        release(s);
+        return true;
+    }
+
+    // Move site s to p, keeping its id; false, with nothing moved, if there
+    // is no site s or another site is at p.
+    bool move(int s, const Point &p) {
+        if (!contains(s)) return false;
+        if (points[s] == p) return true;
+        if (flat) {
+            if (occupied(p, s)) return false;
+            points[s] = p;
+            if (liveCount >= 3) triangulate();
+            return true;
+        }
+        if (!conflict(locate(p, edgeOf[s]), p)) return false;
+        unlink(s);
+        points[s] = p;
+        if (flat)
+            triangulate();
+        else
+            fan(s, locate(p, hint));
+        return true;
+    }
+
+    bool contains(int s) const { return s >= 0 && s < static_cast<int>(points.size()) && alive[s]; }
+
+    const Point &site(int s) const { return points[s]; }
+
+    // Number of sites, and one more than the largest id.
+    std::size_t size() const { return liveCount; }
+    std::size_t idBound() const { return points.size(); }
+
+    // Number of Delaunay triangles, none while the sites are collinear.
+    std::size_t triangleCount() const { return finiteTriangles; }
+
+    // The sites whose cells share an edge with that of s, counterclockwise.
+    // While there are no triangles, none.
+    void neighbours(int s, std::vector<int> &out) const {
+        out.clear();
+        if (!contains(s) || edgeOf[s] < 0) return;
+        int h0 = edgeOf[s], h = h0;
+        do {
+            if (vert[next(h)] != Infinite) out.push_back(vert[next(h)]);
+            h = twin[prev(h)];
+        } while (h != h0);
+    }
+
+    // The corners of the cell of s, counterclockwise, and whether it is
+    // bounded.  An unbounded cell gives the corners from its edge that comes
+    // in from infinity to the one that goes out.
+    bool cell(int s, std::vector<RealPoint> &corners) const {
+        corners.clear();
+        if (!contains(s) || edgeOf[s] < 0) return false;
+
+        // Start past the ghost triangles, if any.
+        int h0 = edgeOf[s], h = h0;
+        bool bounded = true;
+        do {
+            if (ghost(h / 3)) {
+                bounded = false;
+                h0 = h;
+            }
+            h = twin[prev(h)];
+        } while (h != edgeOf[s]);
+
+        h = h0;
+        do {
+            if (!ghost(h / 3)) corners.push_back(circumcenter(h / 3));
+            h = twin[prev(h)];
+        } while (h != h0);
+        return bounded;
+    }
+
+private:
+    static constexpr int Infinite = -1, Dead = -2;
+
+    // By site id.
+    std::vector<Point> points;
+    std::vector<char> alive;
+    std::vector<int> edgeOf; // A half-edge leaving it, or -1 with no triangles.
+    std::vector<int> freeSites;
+    std::size_t liveCount = 0;
+
+    // By half-edge: the site it starts from, or Infinite, and its twin.
+    std::vector<int> vert, twin;
+    std::vector<int> freeTriangles;
+    std::size_t finiteTriangles = 0;
+    bool flat = true;
+
+    int hint = -1; // A half-edge near the last change.
+    std::uint64_t draws = 0;
+
+    // Scratch of insert(): by site, the new triangle whose border edge
+    // starts there (the ghost half-edge coming in, while triangulating), and
+    // the triangles in conflict with the new site.
+    std::vector<int> startAt;
+    int startAtInfinite = -1;
+    std::vector<char> inCavity;
+    std::vector<int> stack, cavity, newTriangles;
+
+    struct Border {
+        int a, b, outer; // Edge a -> b of the cavity and its twin outside.
+    };
+    std::vector<Border> border;
+
+    // Scratch of remove(): the polygon around the site, linked both ways.
+    std::vector<int> ring, outer, after, before;
+
+    static int next(int h) { return h % 3 == 2 ? h - 2 : h + 1; }
+    static int prev(int h) { return h % 3 == 0 ? h + 2 : h - 1; }
+
+    bool ghost(int t) const { return vert[3*t] == Infinite || vert[3*t + 1] == Infinite || vert[3*t + 2] == Infinite; }
+
+    void link(int h, int g) {
+        twin[h] = g;
+        twin[g] = h;
+    }
+
+    static double orient(const Point &a, const Point &b, const Point &c) {
+        return Predicates::orient(a.first, a.second, b.first, b.second, c.first, c.second);
+    }
+
+    static double incircle(const Point &a, const Point &b, const Point &c, const Point &d) {
+        return Predicates::incircle(a.first, a.second, b.first, b.second, c.first, c.second, d.first, d.second);
+    }
+
+    int claim(const Point &p) {
+        int s;
+        if (!freeSites.empty()) {
+            s = freeSites.back();
+            freeSites.pop_back();
+            points[s] = p;
+            alive[s] = 1;
+        } else {
+            s = static_cast<int>(points.size());
+            points.push_back(p);
+            alive.push_back(1);
+            edgeOf.push_back(-1);
+            startAt.push_back(-1);
+        }
+        ++liveCount;
+        return s;
+    }
+
+    void release(int s) {
+        alive[s] = 0;
+        edgeOf[s] = -1;
+        freeSites.push_back(s);
+        --liveCount;
+    }
+
+    // Is there a site other than `except` at p?  For the collinear case only.
+    bool occupied(const Point &p, int except) const {
+        for (std::size_t s = 0; s < points.size(); ++s)
+            if (alive[s] && points[s] == p && static_cast<int>(s) != except) return true;
+        return false;
+    }
+
+    int newTriangle(int a, int b, int c) {
+        int t;
+        if (!freeTriangles.empty()) {
+            t = freeTriangles.back();
+            freeTriangles.pop_back();
+        } else {
+            t = static_cast<int>(vert.size() / 3);
+            vert.resize(vert.size() + 3);
+            twin.resize(twin.size() + 3);
+            inCavity.push_back(0);
+        }
+        vert[3*t] = a;
+        vert[3*t + 1] = b;
+        vert[3*t + 2] = c;
+        if (a != Infinite && b != Infinite && c != Infinite) ++finiteTriangles;
+        return t;
+    }
+
+    void freeTriangle(int t) {
+        if (!ghost(t)) --finiteTriangles;
+        vert[3*t] = vert[3*t + 1] = vert[3*t + 2] = Dead;
+        freeTriangles.push_back(t);
+    }
+
+    void setEdge(int h) {
+        if (vert[h] != Infinite) edgeOf[vert[h]] = h;
+    }
+
+    // Triangulate the live sites with a new sweep.
+    void triangulate() {
+        vert.clear();
+        twin.clear();
+        freeTriangles.clear();
+        inCavity.clear();
+        finiteTriangles = 0;
+        hint = -1;
+        edgeOf.assign(points.size(), -1);
+        startAt.resize(points.size());
+
+        std::vector<int> ids;
+        std::vector<Point> sites;
+        for (std::size_t s = 0; s < points.size(); ++s)
+            if (alive[s]) {
+                ids.push_back(static_cast<int>(s));
+                sites.push_back(points[s]);
+            }
+        BasicVoronoiBuilder<T> builder;
+        builder.setTriangles(true);
+        builder.build(sites);
+        const std::vector<int> &triangles = builder.triangles();
+        flat = triangles.empty();
+        if (flat) return;
+
+        vert.resize(triangles.size());
+        twin.assign(triangles.size(), -1);
+        inCavity.assign(triangles.size() / 3, 0);
+        finiteTriangles = triangles.size() / 3;
+        for (std::size_t h = 0; h < triangles.size(); ++h) vert[h] = ids[triangles[h]];
+
+        // Pair the half-edges.  The sweep makes the two triangles of an edge
+        // at about the same time, so few half-edges wait for their twins at
+        // any one time, and those wait in a small hash table by their ends.
+        Waiting waiting;
+        int halfEdges = static_cast<int>(vert.size());
+        for (int h = 0; h < halfEdges; ++h) {
+            edgeOf[vert[h]] = h;
+            int g = waiting.take(vert[next(h)], vert[h]);
+            if (g >= 0)
+                link(h, g);
+            else
+                waiting.put(vert[h], vert[next(h)], h);
+        }
+
+        // A ghost for each hull edge a -> b: b -> a, a -> infinity and
+        // infinity -> b, the last two linked to the ghosts of the hull edges
+        // next to it.
+        for (int h = 0; h < halfEdges; ++h)
+            if (twin[h] < 0) {
+                int g = newTriangle(vert[next(h)], vert[h], Infinite);
+                link(3*g, h);
+                startAt[vert[next(h)]] = 3*g + 2;
+            }
+        for (int t = halfEdges / 3; t < static_cast<int>(vert.size() / 3); ++t)
+            link(3*t + 1, startAt[vert[3*t + 1]]);
+
+        legalize();
+        hint = 0;
+    }
+
+    // Flip the edges that are not Delaunay, which rounding in the sweep may
+    // leave where sites are nearly cocircular.
+    void legalize() {
+        std::vector<int> queue;
+        for (int e = 0; e < static_cast<int>(vert.size()); ++e) {
+            if (e < twin[e]) queue.push_back(e);
+            while (!queue.empty()) {
+                int h = queue.back(), g = twin[h];
+                queue.pop_back();
+                if (ghost(h / 3) || ghost(g / 3)) continue;
+                const Point &a = points[vert[h]], &b = points[vert[g]];
+                const Point &c = points[vert[prev(h)]], &d = points[vert[prev(g)]];
+                if (incircle(a, b, c, d) <= 0) continue;
+                flip(h);
+                for (int t : {h / 3, g / 3})
+                    for (int k = 0; k < 3; ++k) queue.push_back(3*t + k);
+            }
+        }
+    }
+
+    // Half-edges by their two ends, open addressed.
+    class Waiting {
+    public:
+        void put(int a, int b, int h) {
+            if (2 * (count + 1) > keys.size()) grow();
+            std::size_t i = home(key(a, b));
+            while (keys[i] != empty) i = (i + 1) & mask;
+            keys[i] = key(a, b);
+            values[i] = h;
+            ++count;
+        }
+
+        // Remove and return the half-edge a -> b, or -1.
+        int take(int a, int b) {
+            if (!count) return -1;
+            std::uint64_t k = key(a, b);
+            std::size_t i = home(k);
+            for (; keys[i] != k; i = (i + 1) & mask)
+                if (keys[i] == empty) return -1;
+            int h = values[i];
+            --count;
+
+            // Move back the entries after i that may no longer be reached.
+            for (std::size_t j = (i + 1) & mask; keys[j] != empty; j = (j + 1) & mask) {
+                std::size_t at = home(keys[j]);
+                if (((j - at) & mask) >= ((j - i) & mask)) {
+                    keys[i] = keys[j];
+                    values[i] = values[j];
+                    i = j;
+                }
+            }
+            keys[i] = empty;
+            return h;
+        }
+
+    private:
+        static constexpr std::uint64_t empty = ~std::uint64_t(0);
+        std::vector<std::uint64_t> keys;
+        std::vector<int> values;
+        std::size_t count = 0, mask = 0;
+
+        static std::uint64_t key(int a, int b) {
+            return static_cast<std::uint64_t>(static_cast<std::uint32_t>(a)) << 32 | static_cast<std::uint32_t>(b);
+        }
+
+        std::size_t home(std::uint64_t k) const {
+            return static_cast<std::size_t>((k * 0x9E3779B97F4A7C15u) >> 32) & mask;
+        }
+
+        void grow() {
+            std::vector<std::uint64_t> oldKeys(std::max<std::size_t>(keys.size() * 2, 1024), empty);
+            std::vector<int> oldValues(oldKeys.size());
+            oldKeys.swap(keys);
+            oldValues.swap(values);
+            mask = keys.size() - 1;
+            count = 0;
+            for (std::size_t i = 0; i < oldKeys.size(); ++i)
+                if (oldKeys[i] != empty) {
+                    std::size_t j = home(oldKeys[i]);
+                    while (keys[j] != empty) j = (j + 1) & mask;
+                    keys[j] = oldKeys[i];
+                    values[j] = oldValues[i];
+                    ++count;
+                }
+        }
+    };
+
+    // Replace edge a -> b of triangles (a, b, c) and (b, a, d) by c -> d.
+    void flip(int h) {
+        int g = twin[h];
+        int a = vert[h], b = vert[g], c = vert[prev(h)], d = vert[prev(g)];
+        int bc = twin[next(h)], ca = twin[prev(h)], ad = twin[next(g)], db = twin[prev(g)];
+        int t = h / 3, u = g / 3;
+        vert[3*t] = a, vert[3*t + 1] = d, vert[3*t + 2] = c;
+        vert[3*u] = b, vert[3*u + 1] = c, vert[3*u + 2] = d;
+        link(3*t, ad);
+        link(3*t + 1, 3*u + 1);
+        link(3*t + 2, ca);
+        link(3*u, bc);
+        link(3*u + 2, db);
+        setEdge(3*t);
+        setEdge(3*t + 1);
+        setEdge(3*t + 2);
+        setEdge(3*u);
+    }
+
+    // A triangle in conflict with p, or one with a vertex at p, found by
+    // walking from the triangle of half-edge h across edges that p lies
+    // beyond.  In a Delaunay triangulation the walk cannot go round in
+    // circles.
+    int locate(const Point &p, int h) const {
+        if (h < 0 || vert[h] == Dead) h = hint;
+        int t = h / 3;
+        if (ghost(t))
+            for (int k = 0; k < 3; ++k)
+                if (vert[3*t + k] != Infinite && vert[next(3*t + k)] != Infinite) {
+                    t = twin[3*t + k] / 3;
+                    break;
+                }
+
+        int from = -1;
+        for (;;) {
+            int k = 0;
+            for (; k < 3; ++k) {
+                int e = 3*t + k;
+                if (e != from && orient(points[vert[e]], points[vert[next(e)]], p) < 0) break;
+            }
+            if (k == 3) return t;
+            from = twin[3*t + k];
+            t = from / 3;
+            if (ghost(t)) return t;
+        }
+    }
+
+    // A half-edge to walk to p from: that of the nearest of the vertex at
+    // the last change and about n^(1/3) sites drawn at random, which keeps
+    // the walk about as short (Muecke, Saias and Zhu's jump-and-walk).
+    int jump(const Point &p) {
+        int best = vert[hint] != Infinite ? vert[hint] : vert[next(hint)];
+        Real closest = distance(points[best], p);
+        std::size_t samples = static_cast<std::size_t>(std::cbrt(static_cast<double>(liveCount)));
+        for (std::size_t k = 0; k < samples; ++k) {
+            // A Weyl sequence, mixed.
+            std::uint64_t z = (draws += 0x9E3779B97F4A7C15u);
+            z = (z ^ (z >> 31)) * 0xBF58476D1CE4E5B9u;
+            int s = static_cast<int>((z ^ (z >> 29)) % points.size());
+            if (edgeOf[s] < 0) continue;
+            Real d = distance(points[s], p);
+            if (d < closest) {
+                closest = d;
+                best = s;
+            }
+        }
+        return edgeOf[best];
+    }
+
+    static Real distance(const Point &a, const Point &b) {
+        Real dx = Real(a.first) - b.first, dy = Real(a.second) - b.second;
+        return dx*dx + dy*dy;
+    }
+
+    // Is p inside the circumcircle of triangle t?  That of a ghost is the
+    // open half-plane beyond its hull edge, and the inside of the edge.
+    bool conflict(int t, const Point &p) const {
+        for (int k = 0; k < 3; ++k)
+            if (vert[3*t + k] == Infinite) {
+                const Point &a = points[vert[next(3*t + k)]], &b = points[vert[prev(3*t + k)]];
+                double side = orient(a, b, p);
+                if (side != 0) return side > 0;
+                if (a.first != b.first) return std::min(a.first, b.first) < p.first && p.first < std::max(a.first, b.first);
+                return std::min(a.second, b.second) < p.second && p.second < std::max(a.second, b.second);
+            }
+        return incircle(points[vert[3*t]], points[vert[3*t + 1]], points[vert[3*t + 2]], p) > 0;
+    }
+
+    // Put site s, which triangle t is in conflict with, into the
+    // triangulation.
+    void fan(int s, int t) {
+        const Point &p = points[s];
+        border.clear();
+        cavity.clear();
+        stack.assign(1, t);
+        inCavity[t] = 1;
+        while (!stack.empty()) {
+            int u = stack.back();
+            stack.pop_back();
+            cavity.push_back(u);
+            for (int e = 3*u; e < 3*u + 3; ++e) {
+                int n = twin[e] / 3;
+                if (inCavity[n]) continue;
+                if (conflict(n, p)) {
+                    inCavity[n] = 1;
+                    stack.push_back(n);
+                } else {
+                    border.push_back({vert[e], vert[next(e)], twin[e]});
+                }
+            }
+        }
+        for (int u : cavity) {
+            inCavity[u] = 0;
+            freeTriangle(u);
+        }
+
+        // Triangle (a, b, s) on each border edge; b -> s is the twin of
+        // s -> b in the triangle on the border edge that starts at b.
+        newTriangles.clear();
+        for (const Border &e : border) {
+            int n = newTriangle(e.a, e.b, s);
+            link(3*n, e.outer);
+            (e.a == Infinite ? startAtInfinite : startAt[e.a]) = n;
+            setEdge(3*n);
+            newTriangles.push_back(n);
+        }
+        for (int n : newTriangles) {
+            int b = vert[3*n + 1];
+            link(3*n + 1, 3*(b == Infinite ? startAtInfinite : startAt[b]) + 2);
+        }
+        edgeOf[s] = 3*newTriangles.back() + 2;
+        hint = 3*newTriangles.back();
+    }
+
+    // Take site s out of the triangulation and fill in its star.
+    void unlink(int s) {
+        ring.clear();
+        outer.clear();
+        int h0 = edgeOf[s], h = h0;
+        do {
+            ring.push_back(vert[next(h)]);
+            outer.push_back(twin[next(h)]);
+            int t = h / 3;
+            h = twin[prev(h)];
+            freeTriangle(t);
+        } while (h != h0);
+        edgeOf[s] = -1;
+
+        // On the hull the polygon is open, from the site after infinity to
+        // the one before it.
+        std::size_t k = ring.size(), open = k;
+        for (std::size_t i = 0; i < k; ++i)
+            if (ring[i] == Infinite) open = i;
+        if (open < k) {
+            std::rotate(ring.begin(), ring.begin() + open, ring.end());
+            std::rotate(outer.begin(), outer.begin() + open, outer.end());
+        }
+
+        bool closed = open == k;
+        int n = static_cast<int>(k);
+        after.resize(k);
+        before.resize(k);
+        for (int i = 0; i < n; ++i) {
+            after[i] = i + 1 == n ? 0 : i + 1;
+            before[i] = i == 0 ? n - 1 : i - 1;
+        }
+
+        // Cut ears, each a vertex with the two after it, until the polygon is
+        // down to one triangle or the chain has none left.  An ear goes
+        // before the vertex it was cut at, so the one there is tried again.
+        auto inChain = [closed](int v) { return closed || v != 0; };
+        int left = closed ? n : n - 1, i = closed ? 0 : 1;
+        for (int tries = 0; left > (closed ? 3 : 2) && tries < left;) {
+            int j = after[i], l = after[j];
+            if (!inChain(j) || !inChain(l) || !ear(i, j, l)) {
+                i = after[i];
+                if (!inChain(i)) i = after[i];
+                ++tries;
+                continue;
+            }
+            int t = newTriangle(ring[i], ring[j], ring[l]);
+            link(3*t, outer[i]);
+            link(3*t + 1, outer[j]);
+            outer[i] = 3*t + 2;
+            setEdge(3*t);
+            setEdge(3*t + 1);
+            setEdge(3*t + 2);
+            after[i] = l;
+            before[l] = i;
+            --left;
+            tries = 0;
+            if (inChain(before[i])) i = before[i];
+        }
+
+        if (closed) {
+            int j = after[i], l = after[j];
+            int t = newTriangle(ring[i], ring[j], ring[l]);
+            link(3*t, outer[i]);
+            link(3*t + 1, outer[j]);
+            link(3*t + 2, outer[l]);
+            setEdge(3*t);
+            setEdge(3*t + 1);
+            setEdge(3*t + 2);
+            hint = 3*t;
+        } else {
+            // The rest of the chain is the new hull, with a ghost on each
+            // edge: a -> b, b -> infinity and infinity -> a.
+            int in = outer[0], last = -1;
+            for (int a = 1; after[a] != 0; a = after[a]) {
+                int t = newTriangle(ring[a], ring[after[a]], Infinite);
+                link(3*t, outer[a]);
+                link(3*t + 2, last < 0 ? in : 3*last + 1);
+                setEdge(3*t);
+                setEdge(3*t + 1);
+                last = t;
+            }
+            link(3*last + 1, outer[before[0]]);
+            hint = 3*last;
+        }
+
+        if (finiteTriangles == 0) {
+            vert.clear();
+            twin.clear();
+            freeTriangles.clear();
+            inCavity.clear();
+            std::fill(edgeOf.begin(), edgeOf.end(), -1);
+            flat = true;
+            hint = -1;
+        }
+    }
+
+    // Is (i, j, l) of the polygon around a removed site a Delaunay triangle:
+    // a left turn with no other vertex of the polygon inside its circle?
+    bool ear(int i, int j, int l) const {
+        const Point &a = points[ring[i]], &b = points[ring[j]], &c = points[ring[l]];
+        if (orient(a, b, c) <= 0) return false;
+        for (int r = after[l]; r != i; r = after[r])
+            if (ring[r] != Infinite && incircle(a, b, c, points[ring[r]]) > 0) return false;
+        return true;
+    }
+
+    RealPoint circumcenter(int t) const {
+        const Point &a = points[vert[3*t]], &b = points[vert[3*t + 1]], &c = points[vert[3*t + 2]];
+        Real A = Real(b.first) - a.first, B = Real(b.second) - a.second;
+        Real C = Real(c.first) - a.first, D = Real(c.second) - a.second;
+        Real E = A*A + B*B, F = C*C + D*D, G = 2*(A*D - B*C);
+        return RealPoint(a.first + (D*E - B*F) / G, a.second + (A*F - C*E) / G);
+    }
+};
+
+
+#endif //FORTUNE_DYNAMICVORONOI_H
@@ -0,0 +1,108 @@
+#ifndef FORTUNE_EVENTQUEUE_H
+#define FORTUNE_EVENTQUEUE_H
+
+
+#include <cstddef>
+#include <vector>
+
+
+// Addressable min-heap of circle events, earliest first.
+//
+// Events are stored by value and every owner (the arc that vanishes when its
+// event fires) has at most one of them queued. An Event must be ordered by
+// `operator<` and provide an owner pointer `a`; the owner needs an `int queued`
+// member, which the heap keeps equal to the position of its event, or -1.
+// Because an event can be found from its owner, a superseded event is replaced
+// or removed at once instead of being left behind for pop() to discard.
+template <class Event>
+class EventQueue {
+public:
+    typedef decltype(Event::a) Owner;
+
+    bool empty() const { return heap.empty(); }
+    std::size_t size() const { return heap.size(); }
+
+    const Event &top() const { return heap.front(); }
+
+    bool contains(Owner a) const { return a->queued >= 0; }
+
+    // The queued event of a; only valid if contains(a).
+    const Event &of(Owner a) const { return heap[a->queued]; }
+
+    // Queue e, replacing the event its owner already has.
+    void set(const Event &e) {
+        std::size_t i;
+        if (e.a->queued >= 0) {
+            i = e.a->queued;
+            heap[i] = e;
+        } else {
+            i = heap.size();
+            heap.push_back(e);
+        }
+        place(i);
+        if (i > 0 && heap[i] < heap[(i - 1) / 2]) siftUp(i);
+        else siftDown(i);
+    }
+
+    // Drop the event of a, if it has one.
+    void remove(Owner a) {
+        if (a->queued < 0) return;
+        std::size_t i = a->queued;
+        a->queued = -1;
+
+        std::size_t last = heap.size() - 1;
+        if (i != last) {
+            heap[i] = heap[last];
+            place(i);
+        }
+        heap.pop_back();
+        if (i < heap.size()) {
+            if (i > 0 && heap[i] < heap[(i - 1) / 2]) siftUp(i);
+            else siftDown(i);
+        }
+    }
+
+    void pop() { remove(heap.front().a); }
+
+    void clear() {
+        for (Event &e : heap) e.a->queued = -1;
+        heap.clear();
+    }
+
+private:
+    std::vector<Event> heap;
+
+    void place(std::size_t i) { heap[i].a->queued = static_cast<int>(i); }
+
+    void siftUp(std::size_t i) {
+        Event e = heap[i];
+        while (i > 0) {
+            std::size_t parent = (i - 1) / 2;
+            if (!(e < heap[parent])) break;
+            heap[i] = heap[parent];
+            place(i);
+            i = parent;
+        }
+        heap[i] = e;
+        place(i);
+    }
+
+    void siftDown(std::size_t i) {
+        Event e = heap[i];
+        std::size_t n = heap.size();
+        for (;;) {
+            std::size_t child = 2 * i + 1;
+            if (child >= n) break;
+            if (child + 1 < n && heap[child + 1] < heap[child]) ++child;
+            if (!(heap[child] < e)) break;
+            heap[i] = heap[child];
+            place(i);
+            i = child;
+        }
+        heap[i] = e;
+        place(i);
+    }
+};
+
+
+#endif //FORTUNE_EVENTQUEUE_H
@@ -0,0 +1,108 @@
+#ifndef FORTUNE_HALFEDGEDIAGRAM_H
+#define FORTUNE_HALFEDGEDIAGRAM_H
+
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+
+// A diagram as a half-edge structure, held in arrays and linked by index.
+//
+// Edge e is the pair of half-edges 2e and 2e + 1, so the twin of h is h ^ 1.
+// A half-edge runs from its origin to the origin of its twin with its face,
+// the cell of an input site, on its left, so that following next goes
+// counterclockwise around the face.  An edge that runs off to infinity has no
+// vertex at that end: origin is -1 there, and next is -1 for the half-edge
+// running out.  Its direction there is perpendicular to its two sites.
+//
+// Every vertex is where three edges meet.  Four or more cocircular sites give
+// several vertices at one point, joined by edges of length zero.
+template <class T>
+struct HalfEdgeDiagram {
+    typedef std::pair<T, T> Point;
+
+    std::vector<Point> vertices;
+
+    // By half-edge.
+    std::vector<int> origin; // Vertex it starts from, or -1.
+    std::vector<int> next;   // Next around its face, or -1.
+    std::vector<int> face;   // Input index of the site whose cell it bounds.
+
+    // By input site: a half-edge of its cell, the first of the chain for an
+    // unbounded cell, or -1 for a duplicate swept under another index.
+    std::vector<int> faceEdge;
+
+    // By input site: the first half-edge of a second chain, or -1.  Only a
+    // strip between two parallel edges has one, the cell of a site between
+    // two others when all sites are collinear; following next from
+    // faceEdge alone misses half of its boundary.
+    std::vector<int> stripEdge;
+
+    static int twin(int h) { return h ^ 1; }
+
+    std::size_t edgeCount() const { return face.size() / 2; }
+
+    void clear() {
+        vertices.clear();
+        origin.clear();
+        next.clear();
+        face.clear();
+        faceEdge.clear();
+        stripEdge.clear();
+    }
+
+    // New edge between the cells of sites left and right; returns the
+    // half-edge with left as its face.
+    int addEdge(int left, int right) {
+        int h = static_cast<int>(face.size());
+        origin.insert(origin.end(), 2, -1);
+        next.insert(next.end(), 2, -1);
+        face.push_back(left);
+        face.push_back(right);
+        return h;
+    }
+
+    // Make a vertex at v where the edges of half-edges in0 and in1 arrive and
+    // those of out0 and out1 leave (-1 for none), and link the half-edges of
+    // the faces around it.
+    void join(const Point &v, int in0, int in1, int out0, int out1) {
+        int k = static_cast<int>(vertices.size());
+        vertices.push_back(v);
+
+        // The half-edges running into v.
+        int into[4], n = 0;
+        for (int h : {in0, in1})
+            if (h >= 0) {
+                into[n++] = h;
+                origin[twin(h)] = k;
+            }
+        for (int h : {out0, out1})
+            if (h >= 0) {
+                into[n++] = twin(h);
+                origin[h] = k;
+            }
+
+        // Each goes on along the half-edge out of v with the same face.
+        for (int a = 0; a < n; ++a)
+            for (int b = 0; b < n; ++b)
+                if (a != b && face[into[a]] == face[twin(into[b])]) next[into[a]] = twin(into[b]);
+    }
+
+    // Fill in faceEdge and stripEdge once all edges are in, for sites
+    // [0, sites).
+    void findFaces(std::size_t sites) {
+        faceEdge.assign(sites, -1);
+        stripEdge.assign(sites, -1);
+        for (int h = 0; h < static_cast<int>(face.size()); ++h) {
+            int &f = faceEdge[face[h]];
+            if (f >= 0 && origin[f] < 0 && origin[h] < 0)
+                stripEdge[face[h]] = h;
+            else if (f < 0 || origin[h] < 0)
+                f = h;
+        }
+    }
+};
+
+
+#endif //FORTUNE_HALFEDGEDIAGRAM_H
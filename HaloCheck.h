@@ -0,0 +1,241 @@
+#ifndef FORTUNE_HALOCHECK_H
+#define FORTUNE_HALOCHECK_H
+
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+#include "SiteGrid.h"
+#include "VoronoiBuilder.h"
+
+
+// Decides whether an edge of a diagram built from part of the sites is also an
+// edge of the diagram of all of them.
+//
+// A point on the bisector of sites a and b is on the full diagram when the
+// disk around it through a and b holds no other site.  Along a segment those
+// disks are covered by the disks at its two ends, so only the ends need
+// checking.  An end that runs off to infinity makes the disk a half-plane,
+// which is empty exactly when a and b are neighbours on the convex hull.
+//
+// The partial diagram is right about every site it was given, so only the
+// sites left out can spoil an edge.  Callers say which those were with a
+// Region, when the builder was given exactly the sites inside a rectangle,
+// or with a Subset.
+class HaloCheck {
+public:
+    typedef VoronoiBuilder::Point Point;
+    typedef VoronoiBuilder::Seg Seg;
+
+    // Closed axis-aligned rectangle; sides may be infinite.
+    struct Region {
+        double X0, X1, Y0, Y1;
+
+        bool includes(int, const Point &p) const {
+            return X0 <= p.first && p.first <= X1 && Y0 <= p.second && p.second <= Y1;
+        }
+
+        // Were all sites in [x0, x1] x [y0, y1] given?
+        bool covers(double x0, double x1, double y0, double y1) const {
+            return X0 <= x0 && x1 <= X1 && Y0 <= y0 && y1 <= Y1;
+        }
+    };
+
+    // Flags by site index.
+    struct Subset {
+        const std::vector<char> &given;
+
+        bool includes(int k, const Point &) const { return given[k] != 0; }
+        bool covers(double, double, double, double) const { return false; }
+    };
+
+    static Region everywhere() {
+        double inf = std::numeric_limits<double>::infinity();
+        return {-inf, inf, -inf, inf};
+    }
+
+    // `sorted` holds the indices of the distinct sites, ordered by x then y.
+    // `sites` must outlive the HaloCheck.
+    HaloCheck(const Point *sites, std::size_t n, const std::vector<int> &sorted)
+            : sites(sites), grid_(sites, n) {
+        buildHull(sorted);
+    }
+
+    // Is s, with left and right indexing the sites given to the constructor,
+    // an edge of the full diagram?  Sites found inside its disks are added
+    // to `spoilers`, if given; a wrong ray has none to report.
+    template <class Given>
+    bool verify(const Seg &s, const Given &given, std::vector<int> *spoilers = nullptr) const {
+        const Point &a = sites[s.left];
+        bool ok = s.openStart ? hullEdge(s.left, s.right) : emptyDisk(s.start, a, given, spoilers);
+        if (!ok && !spoilers) return false;
+        return (s.openEnd ? hullEdge(s.right, s.left) : emptyDisk(s.end, a, given, spoilers)) && ok;
+    }
+
+    // All the sites, bucketed.
+    const SiteGrid &grid() const { return grid_; }
+
+    // Sweep the sites flagged in `swept`, by input index, together with the
+    // hull; then add every site found spoiling an edge of a site for which
+    // wanted(k) holds, and sweep again until there is none.  keep(s) gets the
+    // edges of the last sweep with a wanted site on either side.  `sorted`
+    // is as for the constructor.
+    template <class Wanted, class Keep>
+    void sweepUntilVerified(const std::vector<int> &sorted, std::vector<char> &swept,
+                            const VoronoiBuilder::BoundingBox &box, Wanted wanted, Keep keep) const {
+        for (int k : hullSites) swept[k] = 1;
+
+        VoronoiBuilder builder;
+        builder.setBounds(box);
+        std::vector<int> index, spoilers;
+        std::vector<Point> part;
+        std::vector<Seg> segs;
+        builder.setSink([&segs](const Seg &s) { segs.push_back(s); });
+
+        for (;;) {
+            index.clear();
+            part.clear();
+            for (int k : sorted)
+                if (swept[k]) {
+                    index.push_back(k);
+                    part.push_back(sites[k]);
+                }
+            bool all = index.size() == sorted.size();
+            segs.clear();
+            builder.build(part);
+
+            bool ok = true;
+            spoilers.clear();
+            for (Seg &s : segs) {
+                s.left = index[s.left];
+                s.right = index[s.right];
+                if ((wanted(s.left) || wanted(s.right)) && !all && !verify(s, Subset{swept}, &spoilers))
+                    ok = false;
+            }
+            if (ok) {
+                for (const Seg &s : segs)
+                    if (wanted(s.left) || wanted(s.right)) keep(s);
+                return;
+            }
+
+            // A wrong ray names no site.  With the whole hull swept that only
+            // comes from rounding, so sweep everything.
+            bool added = false;
+            for (int q : spoilers)
+                if (!swept[q]) swept[q] = 1, added = true;
+            if (!added)
+                for (int k : sorted) swept[k] = 1;
+        }
+    }
+
+private:
+    // Relative slack for sites on the circle, which do not spoil it.
+    static constexpr double tolerance = 1e-10;
+
+    struct PointHash {
+        std::size_t operator()(const Point &p) const {
+            return std::hash<double>()(p.first) * 31 + std::hash<double>()(p.second);
+        }
+    };
+
+    const Point *sites;
+
+    SiteGrid grid_;
+
+    // Sites on the convex hull in counter-clockwise order, sites on its
+    // edges included, by position and by index, and where each one is in
+    // that order.  All sites when they are on one line.
+    std::vector<Point> hullPoints;
+    std::vector<int> hullSites;
+    std::unordered_map<Point, std::size_t, PointHash> hullIndex;
+    bool collinear = false; // All sites on one line: every ray is an edge.
+
+    static double cross(const Point &o, const Point &a, const Point &b) {
+        return (a.first - o.first) * (b.second - o.second) - (a.second - o.second) * (b.first - o.first);
+    }
+
+    // Andrew's monotone chain, keeping sites that lie on hull edges: each of
+    // them has its own ray between its neighbours on the edge.
+    void buildHull(const std::vector<int> &order) {
+        collinear = true;
+        for (std::size_t k = 2; k < order.size() && collinear; ++k)
+            collinear = cross(sites[order[0]], sites[order[1]], sites[order[k]]) == 0;
+        if (collinear) {
+            hullSites = order;
+            return;
+        }
+
+        std::vector<int> lower, upper;
+        for (int k : order) {
+            while (lower.size() >= 2 && cross(sites[lower[lower.size() - 2]], sites[lower.back()], sites[k]) < 0)
+                lower.pop_back();
+            lower.push_back(k);
+        }
+        for (auto k = order.rbegin(); k != order.rend(); ++k) {
+            while (upper.size() >= 2 && cross(sites[upper[upper.size() - 2]], sites[upper.back()], sites[*k]) < 0)
+                upper.pop_back();
+            upper.push_back(*k);
+        }
+        hullSites.assign(lower.begin(), lower.end() - 1);
+        hullSites.insert(hullSites.end(), upper.begin(), upper.end() - 1);
+        for (std::size_t k = 0; k < hullSites.size(); ++k) {
+            hullPoints.push_back(sites[hullSites[k]]);
+            hullIndex[hullPoints.back()] = k;
+        }
+    }
+
+    // Does the hull run from site `from` straight to site `to`, counter-clockwise?
+    bool hullEdge(int from, int to) const {
+        if (collinear) return true;
+        auto f = hullIndex.find(sites[from]);
+        if (f == hullIndex.end()) return false;
+        return hullPoints[(f->second + 1) % hullPoints.size()] == sites[to];
+    }
+
+    // Does the disk around c through site a miss every site not given?
+    template <class Given>
+    bool emptyDisk(const Point &c, const Point &a, const Given &given, std::vector<int> *spoilers) const {
+        double dx = a.first - c.first, dy = a.second - c.second;
+        double r2 = dx * dx + dy * dy, r = std::sqrt(r2);
+        if (given.covers(c.first - r, c.first + r, c.second - r, c.second + r))
+            return true;
+
+        bool empty = true;
+        double limit = r2 * (1 - tolerance);
+        double cell = grid_.cellSize();
+        int i0 = grid_.column(c.first - r), i1 = grid_.column(c.first + r);
+        for (int i = i0; i <= i1; ++i) {
+            // The part of the disk over this column of cells.
+            double cx0 = grid_.left(i), cx1 = cx0 + cell;
+            double ex = c.first < cx0 ? cx0 - c.first : c.first > cx1 ? c.first - cx1 : 0;
+            if (ex > r) continue;
+            double half = std::sqrt(r2 - ex * ex);
+            int j0 = grid_.row(c.second - half), j1 = grid_.row(c.second + half);
+
+            for (int j = j0; j <= j1; ++j) {
+                double cy0 = grid_.bottom(j);
+                if (given.covers(cx0, cx1, cy0, cy0 + cell)) continue;
+
+                for (const int *k = grid_.begin(i, j); k != grid_.end(i, j); ++k) {
+                    int q = *k;
+                    const Point &p = sites[q];
+                    if (given.includes(q, p)) continue;
+                    double px = p.first - c.first, py = p.second - c.second;
+                    if (px * px + py * py < limit) {
+                        if (!spoilers) return false;
+                        spoilers->push_back(q);
+                        empty = false;
+                    }
+                }
+            }
+        }
+        return empty;
+    }
+};
+
+
+#endif //FORTUNE_HALOCHECK_H
@@ -8,57 +8,71 @@
 
 #include <vector>
 #include <algorithm>
-#include <unordered_set>
-#include <stdexcept>
+#include <cstddef>
+#include <numeric>
 
 
 
 
 class HorizontalChecker {
 private:
-    static const int maxNum = 300;
-
-    static constexpr inline int sig_eps16(double x) {
-        return x < -1e-16 ? -1 : x > 1e-16;
-    }
-
-    static bool hasSameX(std::unordered_set<double>& xCoordinates, double x) {
-        for (const double& xCoord : xCoordinates) {
-            if (sig_eps16(std::abs(xCoord - x)) == 0) {
-                return true;
-            }
-        }
-        xCoordinates.insert(x);
-        return false;
+    static constexpr double defaultTolerance = 1e-16;
+
+    // Indices of points, ordered by x-coordinate.
+    template <class Point>
+    static std::vector<std::size_t> sortedByX(const std::vector<Point>& points) {
+        std::vector<std::size_t> order(points.size());
+        std::iota(order.begin(), order.end(), std::size_t(0));
+        std::sort(order.begin(), order.end(), [&points](std::size_t a, std::size_t b) {
+            return points[a].first < points[b].first;
+        });
+        return order;
     }
 
 
 public:
     typedef std::pair<double, double> Point;
+    typedef std::pair<std::size_t, std::size_t> Collision;
 
-    static bool check(const std::vector<Point>& points) {
-
-        if (points.size() > maxNum) {
-            throw std::length_error("Too many points to check.");
-        }
+    // True if no two points have x-coordinates within `tolerance` of each other.
+    // O(n log n): after sorting, only neighbours need to be compared.  Any
+    // pair of coordinates will do for a point.
+    template <class P>
+    static bool check(const std::vector<P>& points, double tolerance = defaultTolerance) {
 
         // No duplicate x-coordinates when there's only one or zero points
         if (points.size() <= 1) {
             return true;
         }
 
-        // Use an unordered set to keep track of encountered x-coordinates
-        std::unordered_set<double> xCoordinates;
+        std::vector<std::size_t> order = sortedByX(points);
 
-        for (const auto& point : points) {
-            double x = point.first;
-            if (hasSameX(xCoordinates, x)) {
+        for (std::size_t k = 1; k < order.size(); ++k) {
+            if (points[order[k]].first - points[order[k - 1]].first <= tolerance) {
                 return false; // Found a duplicate x-coordinate
             }
         }
         return true; // All points have distinct x-coordinates
 
     }
+
+    // Every pair of indices (i, j), i < j, whose x-coordinates lie within
+    // `tolerance` of each other, so callers can move only those points.
+    template <class P>
+    static std::vector<Collision> findCollisions(const std::vector<P>& points,
+                                                 double tolerance = defaultTolerance) {
+        std::vector<Collision> collisions;
+        std::vector<std::size_t> order = sortedByX(points);
+
+        for (std::size_t k = 0; k < order.size(); ++k) {
+            typename P::first_type x = points[order[k]].first;
+            for (std::size_t m = k + 1;
+                 m < order.size() && points[order[m]].first - x <= tolerance; ++m) {
+                collisions.emplace_back(std::min(order[k], order[m]), std::max(order[k], order[m]));
+            }
+        }
+        return collisions;
+    }
 };
 
 
@@ -0,0 +1,215 @@
+#ifndef FORTUNE_PARALLELBUILDER_H
+#define FORTUNE_PARALLELBUILDER_H
+
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <numeric>
+#include <ostream>
+#include <thread>
+#include <vector>
+#include "HaloCheck.h"
+#include "ParallelSort.h"
+#include "SegmentWriter.h"
+#include "VoronoiBuilder.h"
+
+
+// Builds one diagram on several threads.
+//
+// The sites are cut into vertical slabs holding equal numbers of them, and
+// each slab is swept on its own thread together with a halo: the sites within
+// some distance of it on either side.  A site is resolved when HaloCheck finds
+// that every edge of its cell is an edge of the full diagram.  Inside the
+// point set that takes a halo of a few site spacings; near its hull the empty
+// disks grow long, so the cells there are left unresolved and the slabs stay
+// narrow.  (A slab with too many of them is swept again with twice the halo.)
+//
+// The unresolved sites are then swept once more on one thread, together with
+// their neighbours and the hull, and any site HaloCheck finds spoiling one of
+// their edges is added until none does.  Edges of a resolved site come from
+// the slab of the first such site in sweep order, the others from this last
+// sweep, so every edge is output once.  An edge may be cut into pieces at
+// other points than by a single sweep.
+class ParallelBuilder {
+public:
+    typedef VoronoiBuilder::Point Point;
+    typedef VoronoiBuilder::Seg Seg;
+    typedef VoronoiBuilder::BoundingBox BoundingBox;
+
+    explicit ParallelBuilder(unsigned threads = std::thread::hardware_concurrency())
+            : threads(threads ? threads : 1), box{0, 0, 0, 0} {}
+
+    // Slabs are never made smaller than this many sites.
+    void setMinSlabSites(std::size_t n) { minSlabSites = n ? n : 1; }
+
+    void build(const std::vector<Point> &sites) {
+        build(sites.data(), sites.size());
+    }
+
+    void build(const Point *sites, std::size_t input) {
+        output.clear();
+        box = VoronoiBuilder::boundsOf(sites, input);
+
+        order.resize(input);
+        std::iota(order.begin(), order.end(), 0);
+        parallelSort(order.begin(), order.end(), [sites](int a, int b) {
+            return sites[a] < sites[b];
+        }, threads);
+        // Sweep each point once, so that every slab sees the same copy of it.
+        order.erase(std::unique(order.begin(), order.end(), [sites](int a, int b) {
+            return sites[a] == sites[b];
+        }), order.end());
+        std::size_t n = order.size();
+
+        std::size_t slabs = std::max<std::size_t>(1, std::min<std::size_t>(threads, n / minSlabSites));
+        std::unique_ptr<HaloCheck> check; // Not needed by a single slab.
+        if (slabs > 1) check.reset(new HaloCheck(sites, input, order));
+
+        // About four times the mean distance between sites.
+        double halo = 4 * std::sqrt((box.X1 - box.X0) * (box.Y1 - box.Y0) / (n ? n : 1));
+
+        resolved.assign(n, 1);
+        std::vector<std::vector<Seg>> found(slabs);
+        std::vector<std::thread> workers;
+        for (std::size_t t = 0; t < slabs; ++t)
+            workers.emplace_back([&, t] {
+                sweepSlab(sites, n * t / slabs, n * (t + 1) / slabs, halo, check.get(), found[t]);
+            });
+        for (std::thread &w : workers) w.join();
+
+        std::vector<Seg> rest;
+        if (std::find(resolved.begin(), resolved.end(), 0) != resolved.end())
+            sweepUnresolved(input, *check, found, rest);
+
+        // Keep the edges each slab owns, naming sites by input index again.
+        workers.clear();
+        for (std::size_t t = 0; t < slabs; ++t)
+            workers.emplace_back([&, t] { keepOwned(n * t / slabs, n * (t + 1) / slabs, found[t]); });
+        for (std::thread &w : workers) w.join();
+
+        std::size_t total = rest.size();
+        for (const std::vector<Seg> &f : found) total += f.size();
+        output.reserve(total);
+        for (const std::vector<Seg> &f : found) output.insert(output.end(), f.begin(), f.end());
+        output.insert(output.end(), rest.begin(), rest.end());
+    }
+
+    const std::vector<Seg> &segments() const { return output; }
+
+    BoundingBox bounds() const { return box; }
+
+    // Same format as VoronoiBuilder::printOutput.
+    void printOutput(std::ostream &out, int precision = -1) const {
+        SegmentWriter writer(out);
+        writer.setPrecision(precision);
+        writer.writeRow(box.X0, box.X1, box.Y0, box.Y1);
+        for (const Seg &s : output)
+            writer.writeRow(s.start.first, s.start.second, s.end.first, s.end.second);
+    }
+
+private:
+    unsigned threads;
+    std::size_t minSlabSites = 1 << 14;
+    BoundingBox box;
+    std::vector<int> order;     // Input indices of the distinct sites, sorted by x then y.
+    std::vector<char> resolved; // By sorted position.
+    std::vector<Seg> output;
+
+    // Sweep the sites at sorted positions [lo, hi) with a halo of at least
+    // `halo`.  `found` gets the edges of their cells, with sites named by
+    // sorted position, and `resolved` says which of the cells are right.
+    void sweepSlab(const Point *sites, std::size_t lo, std::size_t hi, double halo,
+                   const HaloCheck *check, std::vector<Seg> &found) {
+        std::size_t n = order.size();
+        if (lo == hi) return;
+
+        VoronoiBuilder builder;
+        builder.setBounds(box);
+        std::vector<Point> part;
+        std::vector<Seg> segs;
+        builder.setSink([&segs](const Seg &s) { segs.push_back(s); });
+
+        auto xAt = [&](std::size_t k) { return sites[order[k]].first; };
+        for (;;) {
+            HaloCheck::Region given = HaloCheck::everywhere();
+            given.X0 = xAt(lo) - halo;
+            given.X1 = xAt(hi - 1) + halo;
+
+            // Sorted positions [a, b) of the sites inside `given`.
+            std::size_t a = lo, b = hi;
+            while (a > 0 && xAt(a - 1) >= given.X0) --a;
+            while (b < n && xAt(b) <= given.X1) ++b;
+            bool all = a == 0 && b == n;
+
+            part.clear();
+            for (std::size_t k = a; k < b; ++k) part.push_back(sites[order[k]]);
+            segs.clear();
+            segs.reserve(3 * part.size());
+            builder.build(part);
+
+            std::fill(resolved.begin() + lo, resolved.begin() + hi, 1);
+            std::size_t unresolved = 0, mine = 0;
+            for (Seg &s : segs) {
+                std::size_t l = a + s.left, r = a + s.right;
+                bool mineL = lo <= l && l < hi, mineR = lo <= r && r < hi;
+                if (!mineL && !mineR) continue;
+
+                s.left = order[l];
+                s.right = order[r];
+                if (!all && !check->verify(s, given)) {
+                    if (mineL && resolved[l]) resolved[l] = 0, ++unresolved;
+                    if (mineR && resolved[r]) resolved[r] = 0, ++unresolved;
+                }
+                s.left = static_cast<int>(l);
+                s.right = static_cast<int>(r);
+                segs[mine++] = s;
+            }
+            if (unresolved * 16 <= hi - lo) {
+                segs.erase(segs.begin() + mine, segs.end());
+                found.swap(segs);
+                return;
+            }
+            halo *= 2;
+        }
+    }
+
+    // Drop the edges found for positions [lo, hi) that belong to another
+    // slab or to the last sweep.
+    void keepOwned(std::size_t lo, std::size_t hi, std::vector<Seg> &found) const {
+        std::size_t kept = 0;
+        for (const Seg &s : found) {
+            std::size_t l = s.left, r = s.right;
+            std::size_t owner = !resolved[l] ? r : !resolved[r] ? l : std::min(l, r);
+            if (!resolved[owner] || owner < lo || owner >= hi) continue;
+
+            Seg &k = found[kept++];
+            k = s;
+            k.left = order[l];
+            k.right = order[r];
+        }
+        found.erase(found.begin() + kept, found.end());
+    }
+
+    // Sweep the unresolved sites with everything that may border them, and
+    // put their edges with one another in `rest`.
+    void sweepUnresolved(std::size_t input, const HaloCheck &check,
+                         const std::vector<std::vector<Seg>> &found, std::vector<Seg> &rest) const {
+        std::vector<char> unresolved(input, 0), swept(input, 0);
+        for (std::size_t k = 0; k < order.size(); ++k)
+            if (!resolved[k]) unresolved[order[k]] = swept[order[k]] = 1;
+        for (const std::vector<Seg> &f : found)
+            for (const Seg &s : f)
+                if (!resolved[s.left] || !resolved[s.right])
+                    swept[order[s.left]] = swept[order[s.right]] = 1;
+
+        check.sweepUntilVerified(order, swept, box, [&](int k) { return unresolved[k] != 0; },
+                                 [&](const Seg &s) {
+                                     if (unresolved[s.left] && unresolved[s.right]) rest.push_back(s);
+                                 });
+    }
+};
+
+
+#endif //FORTUNE_PARALLELBUILDER_H
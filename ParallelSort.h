@@ -0,0 +1,50 @@
+#ifndef FORTUNE_PARALLELSORT_H
+#define FORTUNE_PARALLELSORT_H
+
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+
+// Sort [first, last) with up to `threads` threads: equal chunks are sorted
+// concurrently, then neighbouring runs are merged pairwise, also concurrently.
+// Falls back to std::sort for one thread or short ranges.
+template <class It, class Compare>
+void parallelSort(It first, It last, Compare cmp, unsigned threads,
+                  std::size_t minChunk = 1 << 15) {
+    std::size_t n = last - first;
+    if (threads > n / minChunk) threads = static_cast<unsigned>(n / minChunk);
+    if (threads <= 1) {
+        std::sort(first, last, cmp);
+        return;
+    }
+
+    std::vector<std::size_t> bounds(threads + 1);
+    for (unsigned t = 0; t <= threads; ++t)
+        bounds[t] = n * t / threads;
+
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; ++t)
+        workers.emplace_back([=] { std::sort(first + bounds[t], first + bounds[t + 1], cmp); });
+    for (std::thread &w : workers) w.join();
+
+    // Merge runs [b0, b1) and [b1, b2) until one run is left.
+    while (bounds.size() > 2) {
+        std::vector<std::size_t> merged;
+        workers.clear();
+        for (std::size_t i = 0; i + 2 < bounds.size(); i += 2) {
+            std::size_t b0 = bounds[i], b1 = bounds[i + 1], b2 = bounds[i + 2];
+            workers.emplace_back([=] { std::inplace_merge(first + b0, first + b1, first + b2, cmp); });
+            merged.push_back(b0);
+        }
+        if (bounds.size() % 2 == 0) merged.push_back(bounds[bounds.size() - 2]);
+        merged.push_back(bounds.back());
+        for (std::thread &w : workers) w.join();
+        bounds.swap(merged);
+    }
+}
+
+
+#endif //FORTUNE_PARALLELSORT_H
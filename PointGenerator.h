@@ -7,41 +7,215 @@
 
 
 
-#include <random>
-#include <ctime>
+#include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <utility>
+#include <vector>
 
 
 
+// Random points for tests and benchmarks.
+//
+// Every number is a pure function of the seed and of the index of the point
+// it belongs to, computed by the Philox4x32-10 counter-based generator, so the
+// points are filled in parallel and come out bit for bit the same whatever
+// the number of threads.  The same seed gives the same points on every run.
 class PointGenerator {
 
 private:
-    unsigned seed;
-    std::mt19937 gen;
-    int numPoints;
+    std::uint64_t seed_;
+    unsigned threads;
+
+    // Streams of the counter, one per kind of draw.
+    enum Stream : std::uint32_t { Points, Centers, Darts };
+
 public:
     typedef std::pair<double, double> point;
 
-    PointGenerator() {
-        // 使用当前时间作为种子
-        seed = std::chrono::high_resolution_clock::now().time_since_epoch().count();
-        gen = std::mt19937(seed);
+    // Seeded from the clock; seed() tells how to get the same points again.
+    PointGenerator()
+            : PointGenerator(static_cast<std::uint64_t>(
+                                     std::chrono::high_resolution_clock::now().time_since_epoch().count())) {}
+
+    explicit PointGenerator(std::uint64_t seed, unsigned threads = std::thread::hardware_concurrency())
+            : seed_(seed), threads(threads ? threads : 1) {}
+
+    std::uint64_t seed() const { return seed_; }
+
+    void setThreads(unsigned n) { threads = n ? n : 1; }
+
+    // Points uniform in [minX, maxX) x [minY, maxY), drawn in double.
+    template <class T = double>
+    std::vector<std::pair<T, T>> generatePoints(int num, double minX, double maxX, double minY, double maxY) {
+        std::vector<std::pair<T, T>> points(std::max(num, 0));
+        parallelFor(points.size(), [&](std::size_t k) {
+            Block b = draw(Points, k, 0);
+            points[k] = {static_cast<T>(minX + (maxX - minX) * b.u0), static_cast<T>(minY + (maxY - minY) * b.u1)};
+        });
+        return points;
     }
 
-    std::vector<point> generatePoints(int num, double minX, double maxX, double minY, double maxY) {
-        this->numPoints = num;
-        std::uniform_real_distribution<> x_dist(minX, maxX);
-        std::uniform_real_distribution<> y_dist(minY, maxY);
+    // Points in Gaussian clusters: each is drawn around one of `clusters`
+    // centers uniform in the box, with standard deviation sigma on either
+    // axis.  They may fall outside the box.
+    template <class T = double>
+    std::vector<std::pair<T, T>> generateClusters(int num, int clusters, double sigma,
+                                                  double minX, double maxX, double minY, double maxY) {
+        std::vector<point> centers(std::max(clusters, 1));
+        parallelFor(centers.size(), [&](std::size_t c) {
+            Block b = draw(Centers, c, 0);
+            centers[c] = {minX + (maxX - minX) * b.u0, minY + (maxY - minY) * b.u1};
+        });
+
+        std::vector<std::pair<T, T>> points(std::max(num, 0));
+        parallelFor(points.size(), [&](std::size_t k) {
+            Block pick = draw(Points, k, 0), spread = draw(Points, k, 1);
+            std::size_t c = std::min(centers.size() - 1, static_cast<std::size_t>(pick.u0 * centers.size()));
+
+            // Box-Muller; 1 - u is in (0, 1].
+            double r = sigma * std::sqrt(-2 * std::log(1 - spread.u0)), a = 2 * pi * spread.u1;
+            points[k] = {static_cast<T>(centers[c].first + r * std::cos(a)),
+                         static_cast<T>(centers[c].second + r * std::sin(a))};
+        });
+        return points;
+    }
 
-        std::vector<point> points;
+    // The first num points of a grid of square cells over the box, row by
+    // row, each moved from the center of its cell by up to jitter / 2 cell
+    // widths on either axis.
+    template <class T = double>
+    std::vector<std::pair<T, T>> generateJitteredGrid(int num, double jitter,
+                                                      double minX, double maxX, double minY, double maxY) {
+        std::vector<std::pair<T, T>> points(std::max(num, 0));
+        if (points.empty()) return points;
+        double w = maxX - minX, h = maxY - minY;
+        std::size_t cols = static_cast<std::size_t>(std::ceil(std::sqrt(points.size() * (h > 0 ? w / h : 1))));
+        cols = std::max<std::size_t>(cols, 1);
+        std::size_t rows = (points.size() + cols - 1) / cols;
+        double cw = w / cols, ch = h / rows;
+        parallelFor(points.size(), [&](std::size_t k) {
+            Block b = draw(Points, k, 0);
+            double x = minX + cw * (k % cols + 0.5 + jitter * (b.u0 - 0.5));
+            double y = minY + ch * (k / cols + 0.5 + jitter * (b.u1 - 0.5));
+            points[k] = {static_cast<T>(x), static_cast<T>(y)};
+        });
+        return points;
+    }
+
+    // Poisson-disk points in the box: no two closer than radius, and few
+    // gaps where another would fit.  About 0.67 / radius^2 of them per unit
+    // of area.
+    //
+    // The box is cut into cells a radius / sqrt(2) wide, which hold at most
+    // one point each.  Cells three apart cannot conflict, so they take turns
+    // in nine phases, the cells of a phase throwing darts in parallel; each
+    // dart is drawn from the cell's own counters, which keeps the result
+    // independent of the threads.
+    template <class T = double>
+    std::vector<std::pair<T, T>> generatePoissonDisk(double radius, double minX, double maxX, double minY, double maxY) {
+        std::vector<std::pair<T, T>> points;
+        if (!(radius > 0) || !(maxX > minX) || !(maxY > minY)) return points;
+        double side = radius / std::sqrt(2.0);
+        std::size_t nx = static_cast<std::size_t>(std::ceil((maxX - minX) / side));
+        std::size_t ny = static_cast<std::size_t>(std::ceil((maxY - minY) / side));
+        std::vector<point> cells(nx * ny);
+        std::vector<char> taken(nx * ny, 0);
+
+        auto fits = [&](std::size_t i, std::size_t j, const point &p) {
+            std::size_t i0 = i < 2 ? 0 : i - 2, j0 = j < 2 ? 0 : j - 2;
+            for (std::size_t b = j0; b <= j + 2 && b < ny; ++b)
+                for (std::size_t a = i0; a <= i + 2 && a < nx; ++a) {
+                    if (!taken[b * nx + a]) continue;
+                    double dx = cells[b * nx + a].first - p.first, dy = cells[b * nx + a].second - p.second;
+                    if (dx * dx + dy * dy < radius * radius) return false;
+                }
+            return true;
+        };
+
+        for (std::uint32_t round = 0; round < rounds; ++round)
+            for (std::size_t phase = 0; phase < 9; ++phase) {
+                std::size_t px = phase % 3, py = phase / 3;
+                parallelFor((ny + 2 - py) / 3, 1, [&](std::size_t row) {
+                    std::size_t j = py + 3 * row;
+                    for (std::size_t i = px; i < nx; i += 3) {
+                        std::size_t c = j * nx + i;
+                        for (std::uint32_t d = 0; d < darts && !taken[c]; ++d) {
+                            Block b = draw(Darts, c, round * darts + d);
+                            point p(minX + side * (i + b.u0), minY + side * (j + b.u1));
+                            if (p.first < maxX && p.second < maxY && fits(i, j, p)) {
+                                cells[c] = p;
+                                taken[c] = 1;
+                            }
+                        }
+                    }
+                });
+            }
+
+        for (std::size_t c = 0; c < cells.size(); ++c)
+            if (taken[c]) points.emplace_back(static_cast<T>(cells[c].first), static_cast<T>(cells[c].second));
+        return points;
+    }
+
+private:
+    static constexpr double pi = 3.14159265358979323846;
+
+    // Darts per cell and round, and rounds, of generatePoissonDisk.
+    static constexpr std::uint32_t darts = 4, rounds = 4;
+
+    // Two uniform numbers in [0, 1), 53 bits each.
+    struct Block {
+        double u0, u1;
+    };
+
+    // Draw number `n` of item `index` in `stream`.
+    Block draw(Stream stream, std::uint64_t index, std::uint32_t n) const {
+        std::uint32_t c[4] = {static_cast<std::uint32_t>(index), static_cast<std::uint32_t>(index >> 32), n, stream};
+        philox(c, static_cast<std::uint32_t>(seed_), static_cast<std::uint32_t>(seed_ >> 32));
+        std::uint64_t a = (static_cast<std::uint64_t>(c[0]) << 32) | c[1];
+        std::uint64_t b = (static_cast<std::uint64_t>(c[2]) << 32) | c[3];
+        const double unit = 1.0 / 9007199254740992.0; // 2^-53
+        return {static_cast<double>(a >> 11) * unit, static_cast<double>(b >> 11) * unit};
+    }
 
-        for (int i = 0; i < numPoints; ++i) {
-            double x = x_dist(gen);
-            double y = y_dist(gen);
-            points.emplace_back(x, y);
+    // Philox4x32-10 (Salmon et al., "Parallel random numbers: as easy as
+    // 1, 2, 3"), in place.
+    static void philox(std::uint32_t c[4], std::uint32_t k0, std::uint32_t k1) {
+        for (int round = 0; round < 10; ++round) {
+            std::uint64_t p0 = static_cast<std::uint64_t>(0xD2511F53u) * c[0];
+            std::uint64_t p1 = static_cast<std::uint64_t>(0xCD9E8D57u) * c[2];
+            std::uint32_t hi0 = static_cast<std::uint32_t>(p0 >> 32), lo0 = static_cast<std::uint32_t>(p0);
+            std::uint32_t hi1 = static_cast<std::uint32_t>(p1 >> 32), lo1 = static_cast<std::uint32_t>(p1);
+            c[0] = hi1 ^ c[1] ^ k0;
+            c[1] = lo1;
+            c[2] = hi0 ^ c[3] ^ k1;
+            c[3] = lo0;
+            k0 += 0x9E3779B9u;
+            k1 += 0xBB67AE85u;
         }
+    }
 
-        return points;
+    // f(k) for k < n, in equal ranges over the threads, each range at least
+    // `grain` long.
+    template <class F>
+    void parallelFor(std::size_t n, F f) const { parallelFor(n, 4096, f); }
+
+    template <class F>
+    void parallelFor(std::size_t n, std::size_t grain, F f) const {
+        std::size_t t = std::min<std::size_t>(threads, n / grain + 1);
+        if (t <= 1) {
+            for (std::size_t k = 0; k < n; ++k) f(k);
+            return;
+        }
+        std::vector<std::thread> workers;
+        for (std::size_t w = 0; w < t; ++w)
+            workers.emplace_back([&, w] {
+                for (std::size_t k = n * w / t, e = n * (w + 1) / t; k < e; ++k) f(k);
+            });
+        for (std::thread &w : workers) w.join();
     }
 
 };
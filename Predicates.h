@@ -0,0 +1,289 @@
+#ifndef FORTUNE_PREDICATES_H
+#define FORTUNE_PREDICATES_H
+
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+#if defined(__SIZEOF_INT128__)
+#define FORTUNE_EXACT_PREDICATES 1
+#endif
+
+
+// Exact predicates of the sweep and of DynamicVoronoi.
+//
+// Each first evaluates its polynomial in doubles together with a bound on the
+// rounding error, and only when the sign is in doubt evaluates it again
+// exactly: in floating-point expansions for double coordinates, in 128-bit
+// integers (256 bits where it squares) for integer ones.  Integer coordinates
+// may be as large as `limit` in magnitude, which is the range of a 32-bit int.
+class Predicates {
+public:
+    // (b - a) x (c - a), positive for a left turn and negative for a right
+    // turn, with its sign exact; zero only if the three are collinear.  Where
+    // the sign is in doubt the value is that of the exact sum, rounded.
+    static double orient(double ax, double ay, double bx, double by, double cx, double cy) {
+        double l = (bx - ax) * (cy - ay), r = (cx - ax) * (by - ay), det = l - r;
+        double bound = (3 + 16 * eps) * eps * (std::fabs(l) + std::fabs(r));
+        if (det > bound || -det > bound) return det;
+        return orientExact(ax, ay, bx, by, cx, cy);
+    }
+
+    // Positive if d lies inside the circle through a, b and c, which make a
+    // left turn, negative if outside and zero if on it, with its sign exact.
+    static double incircle(double ax, double ay, double bx, double by, double cx, double cy,
+                           double dx, double dy) {
+        double adx = ax - dx, ady = ay - dy, bdx = bx - dx, bdy = by - dy, cdx = cx - dx, cdy = cy - dy;
+        double bc = bdx * cdy - cdx * bdy, ca = cdx * ady - adx * cdy, ab = adx * bdy - bdx * ady;
+        double alift = adx * adx + ady * ady, blift = bdx * bdx + bdy * bdy, clift = cdx * cdx + cdy * cdy;
+        double det = alift * bc + blift * ca + clift * ab;
+        double permanent = (std::fabs(bdx * cdy) + std::fabs(cdx * bdy)) * alift
+                           + (std::fabs(cdx * ady) + std::fabs(adx * cdy)) * blift
+                           + (std::fabs(adx * bdy) + std::fabs(bdx * ady)) * clift;
+        double bound = (10 + 96 * eps) * eps * permanent;
+        if (det > bound || -det > bound) return det;
+        return incircleExact(ax, ay, bx, by, cx, cy, dx, dy);
+    }
+
+#ifdef FORTUNE_EXACT_PREDICATES
+    typedef std::int64_t Int;
+    typedef __int128 Int128;
+
+    static constexpr Int limit = 2147483647;
+
+    // Sign of (b - a) x (c - a): 1 for a left turn, -1 for a right turn, 0 if
+    // the three are collinear.
+    static int orient(Int ax, Int ay, Int bx, Int by, Int cx, Int cy) {
+        double A = static_cast<double>(bx - ax), B = static_cast<double>(by - ay);
+        double C = static_cast<double>(cx - ax), D = static_cast<double>(cy - ay);
+        double l = A * D, r = C * B, det = l - r;
+        double bound = 4 * eps * (std::fabs(l) + std::fabs(r));
+        if (det > bound) return 1;
+        if (-det > bound) return -1;
+
+        Int128 e = static_cast<Int128>(bx - ax) * (cy - ay) - static_cast<Int128>(cx - ax) * (by - ay);
+        return sign(e);
+    }
+
+    // The center of the circle through a, b and c, which make a right turn,
+    // is a + (nx, ny) / q, with q > 0.
+    static void circumcenter(Int ax, Int ay, Int bx, Int by, Int cx, Int cy,
+                             Int128 *nx, Int128 *ny, Int128 *q) {
+        Int A = bx - ax, B = by - ay, C = cx - ax, D = cy - ay;
+        Int128 Pb = static_cast<Int128>(A) * A + static_cast<Int128>(B) * B;
+        Int128 Pc = static_cast<Int128>(C) * C + static_cast<Int128>(D) * D;
+        *nx = B * Pc - D * Pb;
+        *ny = C * Pb - A * Pc;
+        *q = 2 * (static_cast<Int128>(B) * C - static_cast<Int128>(A) * D);
+    }
+
+    // Sign of X - sx, where X is the rightmost x of the circle through a, b
+    // and c, which make a right turn: the x at which the sweep reaches their
+    // circle event.  -1 or 0 means the event comes before a site at sx.
+    static int circleRight(Int ax, Int ay, Int bx, Int by, Int cx, Int cy, Int sx) {
+        // With a at the origin, X - sx = (sqrt(nx^2 + ny^2) - t) / q, where
+        // t = (sx - ax) q - nx.  All terms are polynomials in the differences
+        // below; m* bound the magnitudes that go into each.
+        double A = static_cast<double>(bx - ax), B = static_cast<double>(by - ay);
+        double C = static_cast<double>(cx - ax), D = static_cast<double>(cy - ay);
+        double s = static_cast<double>(sx - ax);
+        double Pb = A * A + B * B, Pc = C * C + D * D;
+        double nx = B * Pc - D * Pb, ny = C * Pb - A * Pc, q = 2 * (B * C - A * D);
+        double mnx = std::fabs(B) * Pc + std::fabs(D) * Pb, mny = std::fabs(C) * Pb + std::fabs(A) * Pc;
+        double mq = 2 * (std::fabs(B * C) + std::fabs(A * D));
+        double t = s * q - nx, mt = std::fabs(s) * mq + mnx;
+        if (-t > 8 * eps * mt) return 1;
+        if (t > 8 * eps * mt) {
+            double diff = (nx * nx + ny * ny) - t * t;
+            double bound = 32 * eps * (mnx * mnx + mny * mny + mt * mt);
+            if (diff > bound) return 1;
+            if (-diff > bound) return -1;
+        }
+
+        Int128 enx, eny, eq;
+        circumcenter(ax, ay, bx, by, cx, cy, &enx, &eny, &eq);
+        Int128 et = static_cast<Int128>(sx - ax) * eq - enx;
+        if (et < 0) return 1;
+        Wide r = add(square(magnitude(enx)), square(magnitude(eny)));
+        return compare(r, square(static_cast<unsigned __int128>(et)));
+    }
+
+    // Sign of py - Y, where Y is the y of the breakpoint between the arcs of
+    // a (below) and b (above) with the sweep line at px: -1 if (px, py) meets
+    // the front on the arc of a, 1 if on that of b.  Both sites must lie left
+    // of the sweep line and have different x.
+    static int breakpointSide(Int ax, Int ay, Int bx, Int by, Int px, Int py) {
+        // At height y the front is the arc of a when
+        //     S = (a.x - b.x) da db - (a.y - y)^2 db + (b.y - y)^2 da
+        // is positive, da and db being the distances of a and b from the
+        // sweep line.  S is quadratic in y; the breakpoint is its root with
+        // a below and b above, told from the other by the sign of
+        //     V = db (a.y - y) - da (b.y - y),
+        // half its derivative.
+        double da = static_cast<double>(px - ax), db = static_cast<double>(px - bx);
+        double ya = static_cast<double>(ay - py), yb = static_cast<double>(by - py);
+        double t1 = (db - da) * da * db, t2 = ya * ya * db, t3 = yb * yb * da;
+        double S = t1 - t2 + t3, v1 = db * ya, v2 = da * yb, V = v1 - v2;
+        double boundS = 8 * eps * (std::fabs(t1) + t2 + t3);
+        double boundV = 4 * eps * (std::fabs(v1) + std::fabs(v2));
+        int s = S > boundS ? 1 : -S > boundS ? -1 : 2;
+        int v = V > boundV ? 1 : -V > boundV ? -1 : 2;
+
+        Int eda = px - ax, edb = px - bx, eya = ay - py, eyb = by - py;
+        if (s == 2)
+            s = sign(static_cast<Int128>(edb - eda) * eda * edb
+                     - static_cast<Int128>(eya) * eya * edb + static_cast<Int128>(eyb) * eyb * eda);
+        if (v == 2)
+            v = sign(static_cast<Int128>(edb) * eya - static_cast<Int128>(eda) * eyb);
+
+        if (da < db) {
+            // a is the narrower arc and the front between the two roots.
+            if (s > 0) return -1;
+            if (s == 0) return v <= 0 ? 0 : -1;
+            return v < 0 ? 1 : -1;
+        }
+        // b is the narrower arc and the front between the two roots.
+        if (s < 0) return 1;
+        if (s == 0) return v <= 0 ? 0 : 1;
+        return v < 0 ? -1 : 1;
+    }
+#endif
+
+private:
+    static constexpr double eps = std::numeric_limits<double>::epsilon() / 2;
+
+    // Out of line, to keep the filtered case short where it is inlined.
+#if defined(__GNUC__)
+    __attribute__((noinline))
+#endif
+    static double orientExact(double ax, double ay, double bx, double by, double cx, double cy) {
+        // Multiplied out the determinant is a sum of six products, each of
+        // which is exactly the sum of two doubles.
+        double e[12];
+        int n = 0;
+        const double terms[6][2] = {{bx, cy}, {-bx, ay}, {-ax, cy}, {-cx, by}, {cx, ay}, {ax, by}};
+        for (const double *t : terms) {
+            double hi = t[0] * t[1];
+            grow(e, n, std::fma(t[0], t[1], -hi));
+            grow(e, n, hi);
+        }
+        // The components do not overlap, so their sum has the sign of the
+        // largest.
+        double det = 0;
+        for (int k = 0; k < n; ++k) det += e[k];
+        return det;
+    }
+
+#if defined(__GNUC__)
+    __attribute__((noinline))
+#endif
+    static double incircleExact(double ax, double ay, double bx, double by, double cx, double cy,
+                                double dx, double dy) {
+        // The differences are exact as sums of two doubles, and the products
+        // and sums of those exact as expansions.
+        double adx[2], ady[2], bdx[2], bdy[2], cdx[2], cdy[2];
+        difference(ax, dx, adx);
+        difference(ay, dy, ady);
+        difference(bx, dx, bdx);
+        difference(by, dy, bdy);
+        difference(cx, dx, cdx);
+        difference(cy, dy, cdy);
+
+        double bc[16], ca[16], ab[16], alift[16], blift[16], clift[16];
+        int nbc = 0, nca = 0, nab = 0, na = 0, nb = 0, nc = 0;
+        multiply(bdx, 2, cdy, 2, 1, bc, nbc);
+        multiply(cdx, 2, bdy, 2, -1, bc, nbc);
+        multiply(cdx, 2, ady, 2, 1, ca, nca);
+        multiply(adx, 2, cdy, 2, -1, ca, nca);
+        multiply(adx, 2, bdy, 2, 1, ab, nab);
+        multiply(bdx, 2, ady, 2, -1, ab, nab);
+        multiply(adx, 2, adx, 2, 1, alift, na);
+        multiply(ady, 2, ady, 2, 1, alift, na);
+        multiply(bdx, 2, bdx, 2, 1, blift, nb);
+        multiply(bdy, 2, bdy, 2, 1, blift, nb);
+        multiply(cdx, 2, cdx, 2, 1, clift, nc);
+        multiply(cdy, 2, cdy, 2, 1, clift, nc);
+
+        double e[3 * 2 * 16 * 16];
+        int n = 0;
+        multiply(alift, na, bc, nbc, 1, e, n);
+        multiply(blift, nb, ca, nca, 1, e, n);
+        multiply(clift, nc, ab, nab, 1, e, n);
+        double det = 0;
+        for (int k = 0; k < n; ++k) det += e[k];
+        return det;
+    }
+
+    // a - b as the sum of d[0] and d[1], exactly.
+    static void difference(double a, double b, double d[2]) {
+        double diff = a - b, bv = a - diff, av = diff + bv;
+        d[0] = (a - av) + (bv - b);
+        d[1] = diff;
+    }
+
+    // Add sign * f * g, for expansions f and g, to the expansion e[0 .. n).
+    static void multiply(const double *f, int nf, const double *g, int ng, double sign, double *e, int &n) {
+        for (int i = 0; i < nf; ++i)
+            for (int j = 0; j < ng; ++j) {
+                double a = sign * f[i], hi = a * g[j];
+                grow(e, n, std::fma(a, g[j], -hi));
+                grow(e, n, hi);
+            }
+    }
+
+    // Add q to the expansion e[0 .. n), kept as nonoverlapping components
+    // from the smallest up, without zeros.
+    static void grow(double *e, int &n, double q) {
+        int k = 0;
+        for (int i = 0; i < n; ++i) {
+            double sum = q + e[i], bv = sum - q;
+            double low = (q - (sum - bv)) + (e[i] - bv);
+            q = sum;
+            if (low != 0) e[k++] = low;
+        }
+        if (q != 0) e[k++] = q;
+        n = k;
+    }
+
+#ifdef FORTUNE_EXACT_PREDICATES
+
+    // Unsigned 256-bit numbers, for comparing squares.
+    struct Wide {
+        unsigned __int128 hi, lo;
+    };
+
+    static int sign(Int128 v) { return v > 0 ? 1 : v < 0 ? -1 : 0; }
+
+    static unsigned __int128 magnitude(Int128 v) {
+        return v < 0 ? -static_cast<unsigned __int128>(v) : static_cast<unsigned __int128>(v);
+    }
+
+    static Wide square(unsigned __int128 v) {
+        unsigned __int128 lo = static_cast<std::uint64_t>(v), hi = v >> 64;
+        unsigned __int128 low = lo * lo, cross = lo * hi, high = hi * hi;
+        // v^2 = high 2^128 + 2 cross 2^64 + low.
+        unsigned __int128 mid = (low >> 64) + static_cast<std::uint64_t>(cross) * static_cast<unsigned __int128>(2);
+        Wide w;
+        w.lo = (mid << 64) | static_cast<std::uint64_t>(low);
+        w.hi = high + (cross >> 64) * 2 + (mid >> 64);
+        return w;
+    }
+
+    static Wide add(Wide a, Wide b) {
+        Wide w;
+        w.lo = a.lo + b.lo;
+        w.hi = a.hi + b.hi + (w.lo < a.lo);
+        return w;
+    }
+
+    static int compare(Wide a, Wide b) {
+        if (a.hi != b.hi) return a.hi > b.hi ? 1 : -1;
+        if (a.lo != b.lo) return a.lo > b.lo ? 1 : -1;
+        return 0;
+    }
+#endif
+};
+
+
+#endif //FORTUNE_PREDICATES_H
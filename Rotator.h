@@ -26,20 +26,24 @@ public:
     }
 
 
-    std::vector<Point> rotatePoints(std::vector<Point>& inputPoints) {
+    // Any pair of coordinates will do for a point; they are rotated in their
+    // own type.
+    template <class P>
+    std::vector<P> rotatePoints(std::vector<P>& inputPoints) {
         theta = thetaDis(gen);  // 更新随机角度
-        vector<Point> newPoints;
+        vector<P> newPoints;
         for (auto& p : inputPoints) {
             p = rotatePoint(p, theta);
-            Point newP = p;
+            P newP = p;
             newPoints.push_back(newP);
         }
         return newPoints;
     }
 
-    std::vector<Point> reverseRotatePoints(const std::vector<Point>& inputPoints) {
+    template <class P>
+    std::vector<P> reverseRotatePoints(const std::vector<P>& inputPoints) {
         double reverse_theta = -theta;
-        std::vector<Point> reversedPoints;
+        std::vector<P> reversedPoints;
 
         for (const auto& p : inputPoints) {
             reversedPoints.push_back(rotatePoint(p, reverse_theta));
@@ -54,12 +58,14 @@ private:
     std::uniform_real_distribution<> thetaDis;
     double theta;
 
-    Point rotatePoint(const Point& p, double angle) {
-        double cosA = std::cos(angle);
-        double sinA = std::sin(angle);
-        double x = cosA * p.first - sinA * p.second;
-        double y = sinA * p.first + cosA * p.second;
-        return std::make_pair(x, y);
+    template <class P>
+    P rotatePoint(const P& p, double angle) {
+        typedef typename P::first_type T;
+        T cosA = std::cos(static_cast<T>(angle));
+        T sinA = std::sin(static_cast<T>(angle));
+        T x = cosA * p.first - sinA * p.second;
+        T y = sinA * p.first + cosA * p.second;
+        return P(x, y);
     }
 };
 
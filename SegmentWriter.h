@@ -0,0 +1,81 @@
+#ifndef FORTUNE_SEGMENTWRITER_H
+#define FORTUNE_SEGMENTWRITER_H
+
+
+#include <charconv>
+#include <cstddef>
+#include <ostream>
+#include <vector>
+
+
+// Buffered writer for the four-column text format: space separated numbers,
+// one row per line.
+//
+// Numbers are formatted with std::to_chars, which ignores the stream's
+// locale, and rows are collected in a buffer that is handed to the stream in
+// large blocks, so nothing is flushed per line. By default every number is
+// written as the shortest string that reads back to the same value of its
+// type (float, double or long double); setPrecision(6) gives the digits of a
+// default formatted std::ostream.
+class SegmentWriter {
+public:
+    explicit SegmentWriter(std::ostream &out, std::size_t bufferSize = 1 << 16)
+            : out(out), precision(-1), buffer(bufferSize < minBuffer ? minBuffer : bufferSize), used(0) {}
+
+    SegmentWriter(const SegmentWriter &) = delete;
+    SegmentWriter &operator=(const SegmentWriter &) = delete;
+
+    ~SegmentWriter() { flush(); }
+
+    // Significant digits per number, or a negative value for shortest round
+    // trip.  More than 21 digits carry no information even for a long double.
+    void setPrecision(int digits) { precision = digits > 21 ? 21 : digits; }
+
+    template <class T>
+    void writeRow(T a, T b, T c, T d) {
+        if (buffer.size() - used < maxRow) drain();
+        append(a);
+        buffer[used++] = ' ';
+        append(b);
+        buffer[used++] = ' ';
+        append(c);
+        buffer[used++] = ' ';
+        append(d);
+        buffer[used++] = '\n';
+    }
+
+    // Hand everything buffered to the stream and flush it.
+    void flush() {
+        drain();
+        out.flush();
+    }
+
+private:
+    // Room for one formatted number; the longest, a long double in scientific
+    // notation with 21 digits, takes 29 characters.
+    static const std::size_t maxNumber = 32;
+    static const std::size_t maxRow = 4 * (maxNumber + 1);
+    static const std::size_t minBuffer = 4 * maxRow;
+
+    std::ostream &out;
+    int precision;
+    std::vector<char> buffer;
+    std::size_t used;
+
+    void drain() {
+        if (used) out.write(buffer.data(), static_cast<std::streamsize>(used));
+        used = 0;
+    }
+
+    template <class T>
+    void append(T v) {
+        char *first = buffer.data() + used, *last = first + maxNumber;
+        std::to_chars_result r = precision < 0
+                ? std::to_chars(first, last, v)
+                : std::to_chars(first, last, v, std::chars_format::general, precision);
+        used = r.ptr - buffer.data();
+    }
+};
+
+
+#endif //FORTUNE_SEGMENTWRITER_H
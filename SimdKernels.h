@@ -0,0 +1,250 @@
+#ifndef FORTUNE_SIMDKERNELS_H
+#define FORTUNE_SIMDKERNELS_H
+
+
+#include <cmath>
+#include <cstddef>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define FORTUNE_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+// The helpers taking AVX registers are only ever called from kernels built
+// for AVX, and GCC 12 warns about its own AVX-512 header.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpsabi"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+
+// Breakpoints of many arcs at once, in the lanes of SSE2, AVX2 or AVX-512
+// registers, whichever the processor has; other processors get a scalar
+// loop.  Points come in separate arrays of x and y coordinates.
+//
+// Each lane does the same operations in the same order as
+// VoronoiBuilder::intersection, so a batch gives the same bits as one call
+// per arc, whatever the width.  (Build without floating point contraction,
+// as the default flags do, for that to hold.)
+//
+// Batches pay off from a few dozen arcs on, as when the open edges are
+// extended at the end of a build.  Circle events stay with
+// VoronoiBuilder::circle, whose turn is decided by Predicates::orient.
+class SimdKernels {
+public:
+    enum Level { Scalar, SSE2, AVX2, AVX512 };
+
+    // The widest instruction set this processor runs.
+    static Level level() {
+        static const Level best = detect();
+        return best;
+    }
+
+    static const char *name(Level l) {
+        static const char *const names[] = {"scalar", "sse2", "avx2", "avx512"};
+        return names[l];
+    }
+
+    // (bx[k], by[k]): the breakpoint between the arcs of (x0[k], y0[k]) below
+    // and (x1[k], y1[k]) above with the sweep line at l, for k < n.
+    static void breakpoints(const double *x0, const double *y0, const double *x1, const double *y1,
+                            double l, double *bx, double *by, std::size_t n) {
+        switch (levelFor(n)) {
+#ifdef FORTUNE_SIMD_X86
+            case AVX512: breakpointsAvx512(x0, y0, x1, y1, l, bx, by, n); return;
+            case AVX2: breakpointsAvx2(x0, y0, x1, y1, l, bx, by, n); return;
+            case SSE2: breakpointsSse2(x0, y0, x1, y1, l, bx, by, n); return;
+#endif
+            default: breakpointsScalar(x0, y0, x1, y1, l, bx, by, n);
+        }
+    }
+
+private:
+    static Level detect() {
+#ifdef FORTUNE_SIMD_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) return AVX512;
+        if (__builtin_cpu_supports("avx2")) return AVX2;
+        if (__builtin_cpu_supports("sse2")) return SSE2;
+#endif
+        return Scalar;
+    }
+
+    // The narrowest registers that take the whole batch, so a few arcs do
+    // not pay for wide ones.
+    static Level levelFor(std::size_t n) {
+        Level l = level();
+        if (n <= 2 && l > SSE2) return SSE2;
+        if (n <= 4 && l > AVX2) return AVX2;
+        return l;
+    }
+
+    // Each Lanes type has a register type V with `width` doubles, a mask type
+    // M, and the arithmetic below on them.
+    struct ScalarLanes {
+        typedef double V;
+        typedef bool M;
+        static const int width = 1;
+        static V load(const double *p) { return *p; }
+        static void store(double *p, V a) { *p = a; }
+        static V set(double a) { return a; }
+        static V add(V a, V b) { return a + b; }
+        static V sub(V a, V b) { return a - b; }
+        static V mul(V a, V b) { return a * b; }
+        static V div(V a, V b) { return a / b; }
+        static V sqrt(V a) { return std::sqrt(a); }
+        static M eq(V a, V b) { return a == b; }
+        static M gt(V a, V b) { return a > b; }
+        static M butNot(M a, M b) { return a && !b; }
+        static V select(M m, V a, V b) { return m ? a : b; }
+    };
+
+    // The breakpoint kernel over the registers of Lanes, as function `name`
+    // with the given attributes: whole registers, then the rest padded to
+    // one.  It is stamped out once per instruction set below rather than
+    // written as a template, so that every function holding the registers
+    // is built for their instruction set and none are passed to code built
+    // without it, optimized or not.
+#define FORTUNE_BREAKPOINTS(attributes, Lanes, name)                                                  \
+    attributes static void name##Register(const double *x0, const double *y0, const double *x1,        \
+                                          const double *y1, double l, double *bx, double *by) {        \
+        typedef Lanes L;                                                                               \
+        typedef L::V V;                                                                                \
+        V p0x = L::load(x0), p0y = L::load(y0), p1x = L::load(x1), p1y = L::load(y1);                  \
+        V line = L::set(l), two = L::set(2);                                                           \
+                                                                                                       \
+        /* The quadratic formula, as in VoronoiBuilder::intersection. */                               \
+        V z0 = L::mul(two, L::sub(p0x, line));                                                         \
+        V z1 = L::mul(two, L::sub(p1x, line));                                                         \
+        V a = L::sub(L::div(L::set(1), z0), L::div(L::set(1), z1));                                    \
+        V b = L::mul(L::set(-2), L::sub(L::div(p0y, z0), L::div(p1y, z1)));                            \
+        V ll = L::mul(line, line);                                                                     \
+        V c = L::sub(L::div(L::sub(L::add(L::mul(p0y, p0y), L::mul(p0x, p0x)), ll), z0),              \
+                     L::div(L::sub(L::add(L::mul(p1y, p1y), L::mul(p1x, p1x)), ll), z1));              \
+        V disc = L::sub(L::mul(b, b), L::mul(L::mul(L::set(4), a), c));                                \
+        disc = L::select(L::gt(L::set(0), disc), L::set(0), disc);                                     \
+        V y = L::div(L::sub(L::sub(L::set(0), b), L::sqrt(disc)), L::mul(two, a));                     \
+                                                                                                       \
+        /* Arcs of equal x, and sites on the sweep line. */                                            \
+        L::M sameX = L::eq(p0x, p1x), onLine1 = L::eq(p1x, line);                                      \
+        L::M onLine0 = L::butNot(L::butNot(L::eq(p0x, line), sameX), onLine1);                         \
+        y = L::select(onLine0, p0y, y);                                                                \
+        y = L::select(L::butNot(onLine1, sameX), p1y, y);                                              \
+        y = L::select(sameX, L::mul(L::add(p0y, p1y), L::set(0.5)), y);                                \
+                                                                                                       \
+        /* Plug back into one of the parabola equations. */                                            \
+        V px = L::select(onLine0, p1x, p0x), py = L::select(onLine0, p1y, p0y);                        \
+        V dy = L::sub(py, y);                                                                          \
+        V x = L::div(L::sub(L::add(L::mul(px, px), L::mul(dy, dy)), ll),                               \
+                     L::sub(L::mul(two, px), L::mul(two, line)));                                      \
+        L::store(bx, x);                                                                               \
+        L::store(by, y);                                                                               \
+    }                                                                                                  \
+                                                                                                       \
+    attributes static void name(const double *x0, const double *y0, const double *x1, const double *y1, \
+                                double l, double *bx, double *by, std::size_t n) {                     \
+        const int width = Lanes::width;                                                                \
+        std::size_t k = 0;                                                                             \
+        for (; k + width <= n; k += width)                                                             \
+            name##Register(x0 + k, y0 + k, x1 + k, y1 + k, l, bx + k, by + k);                         \
+        if (k == n) return;                                                                            \
+                                                                                                       \
+        double in[4][width], out[2][width];                                                            \
+        for (int j = 0; j < width; ++j) {                                                              \
+            std::size_t from = k + (static_cast<std::size_t>(j) < n - k ? j : 0);                      \
+            in[0][j] = x0[from];                                                                       \
+            in[1][j] = y0[from];                                                                       \
+            in[2][j] = x1[from];                                                                       \
+            in[3][j] = y1[from];                                                                       \
+        }                                                                                              \
+        name##Register(in[0], in[1], in[2], in[3], l, out[0], out[1]);                                 \
+        for (std::size_t j = 0; j < n - k; ++j) {                                                      \
+            bx[k + j] = out[0][j];                                                                     \
+            by[k + j] = out[1][j];                                                                     \
+        }                                                                                              \
+    }
+
+    FORTUNE_BREAKPOINTS(, ScalarLanes, breakpointsScalar)
+
+#ifdef FORTUNE_SIMD_X86
+    // GCC would otherwise fuse the multiplies and adds of the AVX code into
+    // FMAs, which round differently.
+#ifdef __clang__
+#define FORTUNE_TARGET(isa) __attribute__((target(isa)))
+#else
+#define FORTUNE_TARGET(isa) __attribute__((target(isa), optimize("fp-contract=off")))
+#endif
+
+    struct Sse2Lanes {
+        typedef __m128d V;
+        typedef __m128d M;
+        static const int width = 2;
+        FORTUNE_TARGET("sse2") static V load(const double *p) { return _mm_loadu_pd(p); }
+        FORTUNE_TARGET("sse2") static void store(double *p, V a) { _mm_storeu_pd(p, a); }
+        FORTUNE_TARGET("sse2") static V set(double a) { return _mm_set1_pd(a); }
+        FORTUNE_TARGET("sse2") static V add(V a, V b) { return _mm_add_pd(a, b); }
+        FORTUNE_TARGET("sse2") static V sub(V a, V b) { return _mm_sub_pd(a, b); }
+        FORTUNE_TARGET("sse2") static V mul(V a, V b) { return _mm_mul_pd(a, b); }
+        FORTUNE_TARGET("sse2") static V div(V a, V b) { return _mm_div_pd(a, b); }
+        FORTUNE_TARGET("sse2") static V sqrt(V a) { return _mm_sqrt_pd(a); }
+        FORTUNE_TARGET("sse2") static M eq(V a, V b) { return _mm_cmpeq_pd(a, b); }
+        FORTUNE_TARGET("sse2") static M gt(V a, V b) { return _mm_cmpgt_pd(a, b); }
+        FORTUNE_TARGET("sse2") static M butNot(M a, M b) { return _mm_andnot_pd(b, a); }
+        FORTUNE_TARGET("sse2") static V select(M m, V a, V b) {
+            return _mm_or_pd(_mm_and_pd(m, a), _mm_andnot_pd(m, b));
+        }
+    };
+
+    struct Avx2Lanes {
+        typedef __m256d V;
+        typedef __m256d M;
+        static const int width = 4;
+        FORTUNE_TARGET("avx2") static V load(const double *p) { return _mm256_loadu_pd(p); }
+        FORTUNE_TARGET("avx2") static void store(double *p, V a) { _mm256_storeu_pd(p, a); }
+        FORTUNE_TARGET("avx2") static V set(double a) { return _mm256_set1_pd(a); }
+        FORTUNE_TARGET("avx2") static V add(V a, V b) { return _mm256_add_pd(a, b); }
+        FORTUNE_TARGET("avx2") static V sub(V a, V b) { return _mm256_sub_pd(a, b); }
+        FORTUNE_TARGET("avx2") static V mul(V a, V b) { return _mm256_mul_pd(a, b); }
+        FORTUNE_TARGET("avx2") static V div(V a, V b) { return _mm256_div_pd(a, b); }
+        FORTUNE_TARGET("avx2") static V sqrt(V a) { return _mm256_sqrt_pd(a); }
+        FORTUNE_TARGET("avx2") static M eq(V a, V b) { return _mm256_cmp_pd(a, b, _CMP_EQ_OQ); }
+        FORTUNE_TARGET("avx2") static M gt(V a, V b) { return _mm256_cmp_pd(a, b, _CMP_GT_OQ); }
+        FORTUNE_TARGET("avx2") static M butNot(M a, M b) { return _mm256_andnot_pd(b, a); }
+        FORTUNE_TARGET("avx2") static V select(M m, V a, V b) { return _mm256_blendv_pd(b, a, m); }
+    };
+
+    struct Avx512Lanes {
+        typedef __m512d V;
+        typedef __mmask8 M;
+        static const int width = 8;
+        FORTUNE_TARGET("avx512f") static V load(const double *p) { return _mm512_loadu_pd(p); }
+        FORTUNE_TARGET("avx512f") static void store(double *p, V a) { _mm512_storeu_pd(p, a); }
+        FORTUNE_TARGET("avx512f") static V set(double a) { return _mm512_set1_pd(a); }
+        FORTUNE_TARGET("avx512f") static V add(V a, V b) { return _mm512_add_pd(a, b); }
+        FORTUNE_TARGET("avx512f") static V sub(V a, V b) { return _mm512_sub_pd(a, b); }
+        FORTUNE_TARGET("avx512f") static V mul(V a, V b) { return _mm512_mul_pd(a, b); }
+        FORTUNE_TARGET("avx512f") static V div(V a, V b) { return _mm512_div_pd(a, b); }
+        FORTUNE_TARGET("avx512f") static V sqrt(V a) { return _mm512_sqrt_pd(a); }
+        FORTUNE_TARGET("avx512f") static M eq(V a, V b) { return _mm512_cmp_pd_mask(a, b, _CMP_EQ_OQ); }
+        FORTUNE_TARGET("avx512f") static M gt(V a, V b) { return _mm512_cmp_pd_mask(a, b, _CMP_GT_OQ); }
+        FORTUNE_TARGET("avx512f") static M butNot(M a, M b) { return static_cast<M>(a & ~b); }
+        FORTUNE_TARGET("avx512f") static V select(M m, V a, V b) { return _mm512_mask_blend_pd(m, b, a); }
+    };
+
+    FORTUNE_BREAKPOINTS(FORTUNE_TARGET("sse2"), Sse2Lanes, breakpointsSse2)
+    FORTUNE_BREAKPOINTS(FORTUNE_TARGET("avx2"), Avx2Lanes, breakpointsAvx2)
+    FORTUNE_BREAKPOINTS(FORTUNE_TARGET("avx512f"), Avx512Lanes, breakpointsAvx512)
+
+#undef FORTUNE_TARGET
+#endif
+#undef FORTUNE_BREAKPOINTS
+};
+
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+
+#endif //FORTUNE_SIMDKERNELS_H
@@ -0,0 +1,99 @@
+#ifndef FORTUNE_SITEGRID_H
+#define FORTUNE_SITEGRID_H
+
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+#include "VoronoiBuilder.h"
+
+
+// Uniform grid of square cells over the extent of a set of sites, for finding
+// the sites inside a rectangle or near a point.  The sites are bucketed once,
+// with a counting sort, and only their indices are stored.
+class SiteGrid {
+public:
+    typedef VoronoiBuilder::Point Point;
+    typedef VoronoiBuilder::BoundingBox BoundingBox;
+
+    // About `perCell` sites per cell when they are spread evenly.
+    SiteGrid(const Point *sites, std::size_t n, double perCell = 2) : box{0, 0, 0, 0} {
+        if (n) {
+            box = {sites[0].first, sites[0].first, sites[0].second, sites[0].second};
+        }
+        for (std::size_t k = 1; k < n; ++k) {
+            box.X0 = std::min(box.X0, sites[k].first);
+            box.X1 = std::max(box.X1, sites[k].first);
+            box.Y0 = std::min(box.Y0, sites[k].second);
+            box.Y1 = std::max(box.Y1, sites[k].second);
+        }
+        double w = box.X1 - box.X0, h = box.Y1 - box.Y0;
+        double m = n ? static_cast<double>(n) : 1;
+
+        cell = w > 0 && h > 0 ? std::sqrt(perCell * w * h / m) : perCell * std::max(w, h) / m;
+        if (!(cell > 0)) cell = 1;
+        columns_ = static_cast<int>(w / cell) + 1;
+        rows_ = static_cast<int>(h / cell) + 1;
+
+        start.assign(static_cast<std::size_t>(columns_) * rows_ + 1, 0);
+        std::vector<std::size_t> where(n);
+        for (std::size_t k = 0; k < n; ++k) {
+            where[k] = index(column(sites[k].first), row(sites[k].second));
+            ++start[where[k] + 1];
+        }
+        for (std::size_t c = 1; c < start.size(); ++c) start[c] += start[c - 1];
+        members.resize(n);
+        std::vector<std::size_t> fill(start.begin(), start.end() - 1);
+        for (std::size_t k = 0; k < n; ++k) members[fill[where[k]]++] = static_cast<int>(k);
+    }
+
+    // Smallest box around the sites.
+    const BoundingBox &extent() const { return box; }
+
+    int columns() const { return columns_; }
+    int rows() const { return rows_; }
+    double cellSize() const { return cell; }
+
+    // Lower left corner of cell (i, j).
+    double left(int i) const { return box.X0 + i * cell; }
+    double bottom(int j) const { return box.Y0 + j * cell; }
+
+    // The column or row holding x or y, clamped to the grid.
+    int column(double x) const { return clamp((x - box.X0) / cell, columns_); }
+    int row(double y) const { return clamp((y - box.Y0) / cell, rows_); }
+
+    // The sites in cell (i, j).
+    const int *begin(int i, int j) const { return members.data() + start[index(i, j)]; }
+    const int *end(int i, int j) const { return members.data() + start[index(i, j) + 1]; }
+
+    // f(k) for every site k in the cells that meet [x0, x1] x [y0, y1]; some
+    // of them lie outside it.
+    template <class F>
+    void visit(double x0, double x1, double y0, double y1, F f) const {
+        if (x1 < box.X0 || x0 > box.X1 || y1 < box.Y0 || y0 > box.Y1) return;
+        int i0 = column(x0), i1 = column(x1), j0 = row(y0), j1 = row(y1);
+        for (int j = j0; j <= j1; ++j)
+            for (const int *k = begin(i0, j), *e = end(i1, j); k != e; ++k) f(*k);
+    }
+
+private:
+    BoundingBox box;
+    double cell;
+    int columns_, rows_;
+
+    // Cell c, numbered row by row, holds members[start[c] .. start[c + 1]).
+    std::vector<std::size_t> start;
+    std::vector<int> members;
+
+    std::size_t index(int i, int j) const { return static_cast<std::size_t>(j) * columns_ + i; }
+
+    static int clamp(double c, int count) {
+        if (!(c > 0)) return 0;
+        if (c >= count - 1) return count - 1;
+        return static_cast<int>(c);
+    }
+};
+
+
+#endif //FORTUNE_SITEGRID_H
@@ -0,0 +1,93 @@
+#ifndef FORTUNE_THREADPOOL_H
+#define FORTUNE_THREADPOOL_H
+
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+// Fixed set of worker threads taking tasks from one queue.  wait() blocks
+// until every task submitted so far has run, and rethrows the first
+// exception any of them threw.
+class ThreadPool {
+public:
+    explicit ThreadPool(unsigned threads = std::thread::hardware_concurrency())
+            : running(0), stopping(false) {
+        if (!threads) threads = 1;
+        for (unsigned t = 0; t < threads; ++t)
+            workers.emplace_back([this] { work(); });
+    }
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread &w : workers) w.join();
+    }
+
+    std::size_t size() const { return workers.size(); }
+
+    void submit(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            tasks.push_back(std::move(task));
+        }
+        wake.notify_one();
+    }
+
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex);
+        idle.wait(lock, [this] { return tasks.empty() && running == 0; });
+        if (failure) {
+            std::exception_ptr e = failure;
+            failure = nullptr;
+            std::rethrow_exception(e);
+        }
+    }
+
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::size_t running; // Tasks taken from the queue and not yet finished.
+    bool stopping;
+    std::exception_ptr failure;
+
+    std::mutex mutex;
+    std::condition_variable wake, idle;
+
+    void work() {
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;) {
+            wake.wait(lock, [this] { return stopping || !tasks.empty(); });
+            if (tasks.empty()) return;
+
+            std::function<void()> task = std::move(tasks.front());
+            tasks.pop_front();
+            ++running;
+            lock.unlock();
+            try {
+                task();
+            } catch (...) {
+                lock.lock();
+                if (!failure) failure = std::current_exception();
+                lock.unlock();
+            }
+            lock.lock();
+            if (--running == 0 && tasks.empty()) idle.notify_all();
+        }
+    }
+};
+
+
+#endif //FORTUNE_THREADPOOL_H
@@ -0,0 +1,297 @@
+#ifndef FORTUNE_TILEDBUILDER_H
+#define FORTUNE_TILEDBUILDER_H
+
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "HaloCheck.h"
+#include "ParallelSort.h"
+#include "SiteGrid.h"
+#include "ThreadPool.h"
+#include "VoronoiBuilder.h"
+
+
+// Builds the cells of the sites inside an area, tile by tile, on a pool of
+// threads.
+//
+// The area is cut into a grid of tiles holding about setTileSites() sites
+// each.  A tile is swept together with a halo, the sites within some distance
+// around it, and keeps only the cells of its own sites.  HaloCheck then makes
+// sure each kept cell is the cell of the full diagram; those it cannot vouch
+// for, mostly near the hull where empty disks grow long, are swept again with
+// twice the halo around them until it can.
+class TiledBuilder {
+public:
+    typedef VoronoiBuilder::Point Point;
+    typedef VoronoiBuilder::Seg Seg;
+    typedef VoronoiBuilder::BoundingBox BoundingBox;
+
+    struct Cell {
+        int site;               // Input index.
+        std::size_t begin, end; // Its edges in edges().
+    };
+
+    explicit TiledBuilder(unsigned threads = std::thread::hardware_concurrency())
+            : pool(threads), box{0, 0, 0, 0} {}
+
+    void setTileSites(std::size_t n) { tileSites = n ? n : 1; }
+
+    // Cells of all the sites.
+    void build(const std::vector<Point> &sites) {
+        build(sites.data(), sites.size());
+    }
+
+    void build(const Point *sites, std::size_t n) {
+        double inf = std::numeric_limits<double>::infinity();
+        build(sites, n, {-inf, inf, -inf, inf});
+    }
+
+    // Cells of the sites inside `area`, closed on all sides.  Exact
+    // duplicates have one cell, under the index of one of them.
+    void build(const std::vector<Point> &sites, const BoundingBox &area) {
+        build(sites.data(), sites.size(), area);
+    }
+
+    void build(const Point *sites, std::size_t input, const BoundingBox &area) {
+        cells_.clear();
+        edges_.clear();
+        box = VoronoiBuilder::boundsOf(sites, input);
+
+        std::vector<int> order(input);
+        std::iota(order.begin(), order.end(), 0);
+        parallelSort(order.begin(), order.end(), [sites](int a, int b) {
+            return sites[a] < sites[b];
+        }, static_cast<unsigned>(pool.size()));
+        order.erase(std::unique(order.begin(), order.end(), [sites](int a, int b) {
+            return sites[a] == sites[b];
+        }), order.end());
+
+        HaloCheck check(sites, input, order);
+        distinct.assign(input, 0);
+        for (int k : order) distinct[k] = 1;
+        placeTiles(sites, order, area);
+
+        // About four times the mean distance between sites.
+        double halo = 4 * std::sqrt((box.X1 - box.X0) * (box.Y1 - box.Y0) / (order.empty() ? 1 : order.size()));
+
+        std::size_t tiles = tileStart.size() - 1;
+        std::vector<TileResult> found(tiles);
+        for (std::size_t t = 0; t < tiles; ++t)
+            pool.submit([&, t] { sweepTile(sites, check, t, halo, found[t]); });
+        pool.wait();
+
+        // The cells no tile could vouch for are swept once more, with their
+        // neighbours and whatever spoils them.
+        std::vector<char> leftover(input, 0), swept(input, 0);
+        bool any = false;
+        for (const TileResult &f : found) {
+            for (int c : f.leftover) leftover[cells_[c].site] = swept[cells_[c].site] = 1, any = true;
+            for (int k : f.near) swept[k] = 1;
+        }
+        if (any) {
+            found.emplace_back();
+            std::vector<std::pair<int, Seg>> &rest = found.back().edges;
+            check.sweepUntilVerified(order, swept, box, [&](int k) { return leftover[k] != 0; },
+                                     [&](const Seg &s) {
+                                         if (leftover[s.left]) rest.emplace_back(cellOf[s.left], s);
+                                         if (leftover[s.right]) rest.emplace_back(cellOf[s.right], s);
+                                     });
+        }
+
+        // Group the edges by cell.
+        for (const TileResult &f : found)
+            for (const std::pair<int, Seg> &e : f.edges) ++cells_[e.first].end;
+        std::size_t total = 0;
+        for (Cell &c : cells_) {
+            c.begin = total;
+            total += c.end;
+            c.end = c.begin;
+        }
+        edges_.assign(total, Seg(Point(0, 0), -1, -1));
+        for (const TileResult &f : found)
+            for (const std::pair<int, Seg> &e : f.edges) edges_[cells_[e.first].end++] = e.second;
+        cellOf.clear();
+        distinct.clear();
+    }
+
+    const std::vector<Cell> &cells() const { return cells_; }
+    const std::vector<Seg> &edges() const { return edges_; }
+
+    // The box the rays were extended to, as VoronoiBuilder::bounds().
+    BoundingBox bounds() const { return box; }
+
+private:
+    ThreadPool pool;
+    std::size_t tileSites = 1 << 14;
+    BoundingBox box;
+    std::vector<Cell> cells_;
+    std::vector<Seg> edges_;
+
+    // Scratch for one build, by input index.
+    std::vector<char> distinct; // The copy of a site that is swept.
+    std::vector<int> cellOf;    // Its cell, or -1.
+
+    // Tile t has cells [tileStart[t], tileStart[t + 1]).
+    std::vector<std::size_t> tileStart;
+
+    struct TileResult {
+        std::vector<std::pair<int, Seg>> edges; // By cell.
+        std::vector<int> leftover;              // Cells that never passed.
+        std::vector<int> near;                  // Sites next to them.
+    };
+
+    // Number the cells of the distinct sites inside area, tile by tile.
+    void placeTiles(const Point *sites, const std::vector<int> &order, const BoundingBox &area) {
+        std::vector<int> inside;
+        for (int k : order) {
+            const Point &p = sites[k];
+            if (area.X0 <= p.first && p.first <= area.X1 && area.Y0 <= p.second && p.second <= area.Y1)
+                inside.push_back(k);
+        }
+
+        // Tiles over the sites inside, about as wide as they are high.
+        double x0 = 0, x1 = 0, y0 = 0, y1 = 0;
+        if (!inside.empty()) {
+            x0 = x1 = sites[inside[0]].first;
+            y0 = y1 = sites[inside[0]].second;
+        }
+        for (int k : inside) {
+            x0 = std::min(x0, sites[k].first);
+            x1 = std::max(x1, sites[k].first);
+            y0 = std::min(y0, sites[k].second);
+            y1 = std::max(y1, sites[k].second);
+        }
+        double w = x1 - x0, h = y1 - y0;
+        double tiles = std::max<double>(1, static_cast<double>(inside.size() / tileSites));
+        int nx = w <= 0 ? 1 : h <= 0 ? static_cast<int>(tiles) : static_cast<int>(std::lround(std::sqrt(tiles * w / h)));
+        nx = std::max(1, nx);
+        int ny = std::max(1, static_cast<int>(std::ceil(tiles / nx)));
+        if (h <= 0) ny = 1;
+        double tw = w > 0 ? w / nx : 1, th = h > 0 ? h / ny : 1;
+
+        auto tileOf = [&](const Point &p) {
+            int i = std::min(nx - 1, static_cast<int>((p.first - x0) / tw));
+            int j = std::min(ny - 1, static_cast<int>((p.second - y0) / th));
+            return static_cast<std::size_t>(j) * nx + i;
+        };
+
+        tileStart.assign(static_cast<std::size_t>(nx) * ny + 1, 0);
+        for (int k : inside) ++tileStart[tileOf(sites[k]) + 1];
+        for (std::size_t t = 1; t < tileStart.size(); ++t) tileStart[t] += tileStart[t - 1];
+
+        std::vector<std::size_t> fill(tileStart.begin(), tileStart.end() - 1);
+        cells_.assign(inside.size(), Cell{0, 0, 0});
+        cellOf.assign(distinct.size(), -1);
+        for (int k : inside) {
+            std::size_t c = fill[tileOf(sites[k])]++;
+            cells_[c].site = k;
+            cellOf[k] = static_cast<int>(c);
+        }
+    }
+
+    // Sweep tile t, doubling the halo while many of its cells fail
+    // HaloCheck, and report the edges of those that pass.
+    void sweepTile(const Point *sites, const HaloCheck &check, std::size_t t, double halo,
+                   TileResult &out) const {
+        std::size_t first = tileStart[t], last = tileStart[t + 1];
+        if (first == last) return;
+
+        const SiteGrid &grid = check.grid();
+        const BoundingBox &extent = grid.extent();
+
+        // pending[c - first]: the cell has not passed yet; bad: it failed this time.
+        std::vector<char> pending(last - first, 1), bad(last - first, 0);
+        std::vector<int> index;
+        std::vector<Point> part;
+        std::vector<Seg> segs, touching;
+
+        VoronoiBuilder builder;
+        builder.setBounds(box);
+        builder.setSink([&segs](const Seg &s) { segs.push_back(s); });
+
+        auto mine = [&](int k) {
+            int c = cellOf[k];
+            return c >= static_cast<int>(first) && c < static_cast<int>(last) && pending[c - first];
+        };
+
+        for (;;) {
+            // The pending sites, with the halo around them.
+            HaloCheck::Region given = HaloCheck::everywhere();
+            std::swap(given.X0, given.X1);
+            std::swap(given.Y0, given.Y1);
+            std::size_t count = 0;
+            for (std::size_t c = first; c < last; ++c) {
+                if (!pending[c - first]) continue;
+                const Point &p = sites[cells_[c].site];
+                given.X0 = std::min(given.X0, p.first);
+                given.X1 = std::max(given.X1, p.first);
+                given.Y0 = std::min(given.Y0, p.second);
+                given.Y1 = std::max(given.Y1, p.second);
+                ++count;
+            }
+            given.X0 -= halo;
+            given.X1 += halo;
+            given.Y0 -= halo;
+            given.Y1 += halo;
+            bool all = given.covers(extent.X0, extent.X1, extent.Y0, extent.Y1);
+
+            index.clear();
+            part.clear();
+            grid.visit(given.X0, given.X1, given.Y0, given.Y1, [&](int k) {
+                if (distinct[k] && given.includes(k, sites[k])) {
+                    index.push_back(k);
+                    part.push_back(sites[k]);
+                }
+            });
+            segs.clear();
+            builder.build(part);
+
+            touching.clear();
+            std::size_t failed = 0;
+            for (Seg s : segs) {
+                s.left = index[s.left];
+                s.right = index[s.right];
+                bool l = mine(s.left), r = mine(s.right);
+                if (!l && !r) continue;
+                if (!all && !check.verify(s, given)) {
+                    if (l && !bad[cellOf[s.left] - first]) bad[cellOf[s.left] - first] = 1, ++failed;
+                    if (r && !bad[cellOf[s.right] - first]) bad[cellOf[s.right] - first] = 1, ++failed;
+                }
+                touching.push_back(s);
+            }
+
+            bool retry = failed * 16 > count;
+            for (const Seg &s : touching)
+                for (int k : {s.left, s.right}) {
+                    if (!mine(k)) continue;
+                    int c = cellOf[k];
+                    if (!bad[c - first]) {
+                        out.edges.emplace_back(c, s);
+                    } else if (!retry) {
+                        out.near.push_back(s.left);
+                        out.near.push_back(s.right);
+                    }
+                }
+
+            for (std::size_t c = 0; c < pending.size(); ++c) {
+                pending[c] = bad[c];
+                bad[c] = 0;
+            }
+            if (!retry) break;
+            halo *= 2;
+        }
+
+        for (std::size_t c = first; c < last; ++c)
+            if (pending[c - first]) out.leftover.push_back(static_cast<int>(c));
+    }
+};
+
+
+#endif //FORTUNE_TILEDBUILDER_H
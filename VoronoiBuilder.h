@@ -0,0 +1,811 @@
+#ifndef FORTUNE_VORONOIBUILDER_H
+#define FORTUNE_VORONOIBUILDER_H
+
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+#include "Arena.h"
+#include "BeachLine.h"
+#include "EventQueue.h"
+#include "HalfEdgeDiagram.h"
+#include "ParallelSort.h"
+#include "Predicates.h"
+#include "SegmentWriter.h"
+#include "SimdKernels.h"
+
+
+// Notation for working with points
+
+#define x first
+#define y second
+
+// Statements that only count, compiled in with FORTUNE_STATS.
+#ifdef FORTUNE_STATS
+#define FORTUNE_STAT(...) __VA_ARGS__
+#else
+#define FORTUNE_STAT(...)
+#endif
+
+
+// Fortune's sweep over a set of sites. Every builder owns its own queues,
+// parabolic front and output, so independent builders can run on different
+// threads at the same time.
+//
+// T is the coordinate type of the sites, the output and every computation in
+// between: float halves the memory traffic of large, well conditioned inputs,
+// long double gives badly conditioned ones more room.  Breakpoints and circle
+// events are computed in at least double precision whatever T is, as rays
+// far out in float come apart.  VoronoiBuilder is the double engine.
+template <class T>
+class BasicVoronoiBuilder {
+public:
+    typedef T Scalar;
+    typedef std::pair<T, T> Point;
+
+    struct Seg {
+        Point start, end;
+        bool done;
+        bool openStart; // start is a far point on a ray, not a vertex
+        bool openEnd;   // end is a far point on a ray, not a vertex
+
+        // Input indices of the sites on either side, looking from start to end.
+        int left, right;
+
+        // With half-edges on, the half-edge of halfEdges() this is part of
+        // that runs the same way, with left as its face; otherwise -1.
+        int halfEdge;
+
+        Seg(Point p, int l, int r, bool o = false)
+                : start(p), end(0, 0), done(false), openStart(o), openEnd(false), left(l), right(r),
+                  halfEdge(-1) {}
+
+        // Set the end Point and mark as "done."
+        void finish(Point p) {
+            if (done) return;
+            end = p;
+            done = true;
+        }
+    };
+
+    struct BoundingBox {
+        T X0, X1, Y0, Y1;
+    };
+
+    // How a build went: seconds spent sorting the sites, sweeping and
+    // extending the open edges, and the numbers of site and circle events.
+    struct Timing {
+        double sort, sweep, finish;
+        std::size_t sites, circles;
+    };
+
+#ifdef FORTUNE_STATS
+    // What the sweep of the last build did.  The event queue drops a circle
+    // event as soon as it is invalidated, so invalid events are counted when
+    // dropped rather than when popped.
+    struct SweepStats {
+        std::size_t siteEvents;
+        std::size_t circleEvents;      // Popped, all of them valid.
+        std::size_t invalidEvents;     // Dropped or replaced before they were due.
+        std::size_t maxQueue;          // Most circle events queued at once.
+        std::size_t maxFront;          // Most arcs on the front at once.
+        std::size_t arcsVisited;       // Arcs compared while locating new sites,
+        std::size_t maxArcsVisited;    // in all and for one site.
+        std::size_t intersections;     // Breakpoints computed.
+        double sortSeconds, sweepSeconds, finishSeconds;
+    };
+#endif
+
+    // Receives each segment as soon as the sweep closes it.  The reference is
+    // only valid for the duration of the call.
+    typedef std::function<void(const Seg &)> SegmentSink;
+
+    BasicVoronoiBuilder() = default;
+    BasicVoronoiBuilder(const BasicVoronoiBuilder &) = delete;
+    BasicVoronoiBuilder &operator=(const BasicVoronoiBuilder &) = delete;
+
+    // Sort the sites with this many threads (1 by default).
+    void setSortThreads(unsigned n) { sortThreads = n ? n : 1; }
+
+    // Time the phases of each build for timing(); off, the times stay zero.
+    void setTiming(bool on) { timed = on; }
+
+    // Stream segments to `s` while the sweep runs instead of collecting them
+    // for segments(); memory then only grows with the length of the front.
+    // bounds() is already valid when the first segment arrives.  An empty
+    // sink restores collecting.
+    void setSink(SegmentSink s) { sink = std::move(s); }
+
+    // Also build the diagram as a half-edge structure, for halfEdges().  The
+    // two segments a new site's edge grows into on either side are one edge
+    // there.
+    void setHalfEdges(bool on) { buildHalfEdges = on; }
+
+    // Also collect the dual Delaunay triangles, for triangles().
+    void setTriangles(bool on) { buildTriangles = on; }
+
+    // The sites lie on an integer grid, their coordinates no larger than
+    // Predicates::limit in magnitude.  Turns, breakpoints and the order of
+    // events and sites are then decided exactly, so collinear and cocircular
+    // sites come out right, and build() throws std::runtime_error for a site
+    // off the grid.
+    void setIntegerSites(bool on) {
+#ifndef FORTUNE_EXACT_PREDICATES
+        if (on) throw std::runtime_error("Integer sites need a compiler with 128-bit integers.");
+#endif
+        integerSites = on;
+    }
+
+    // Use b as the bounding box instead of fitting one to the sites, so that
+    // builds over parts of a set of sites extend their edges alike.
+    void setBounds(const BoundingBox &b) {
+        fixedBox = b;
+        boxFixed = true;
+    }
+
+    // Go back to fitting the bounding box to the sites.
+    void fitBounds() { boxFixed = false; }
+
+    // The box build() fits around `sites`: their extent and the origin, grown
+    // by a fifth on every side.
+    static BoundingBox boundsOf(const Point *sites, std::size_t n) {
+        BoundingBox b = {0, 0, 0, 0};
+        for (std::size_t k = 0; k < n; ++k) {
+            const Point &p = sites[k];
+            if (p.x < b.X0) b.X0 = p.x;
+            if (p.y < b.Y0) b.Y0 = p.y;
+            if (p.x > b.X1) b.X1 = p.x;
+            if (p.y > b.Y1) b.Y1 = p.y;
+        }
+        T dx = (b.X1 - b.X0 + 1) / 5, dy = (b.Y1 - b.Y0 + 1) / 5;
+        b.X0 -= dx;
+        b.X1 += dx;
+        b.Y0 -= dy;
+        b.Y1 += dy;
+        return b;
+    }
+
+    // Run the sweep over `sites`, replacing the result of any previous build.
+    // Sites may share x-coordinates; exact duplicates are swept once, under
+    // the index of one of them.
+    void build(const std::vector<Point> &sites) {
+        build(sites.data(), sites.size());
+    }
+
+    void build(const Point *sites, std::size_t n) {
+        reset();
+        Clock::time_point start = stamp();
+
+        points.resize(n);
+        for (std::size_t k = 0; k < n; ++k) {
+            if (integerSites && !(on_grid(sites[k].x) && on_grid(sites[k].y)))
+                throw std::runtime_error("Site off the integer grid.");
+            points[k] = {sites[k], static_cast<int>(k)};
+        }
+        parallelSort(points.begin(), points.end(), lt(), sortThreads);
+        points.erase(std::unique(points.begin(), points.end(),
+                                 [](const Site &a, const Site &b) { return a.p == b.p; }),
+                     points.end());
+        Clock::time_point sorted = stamp();
+
+        BoundingBox b = boxFixed ? fixedBox : boundsOf(sites, n);
+        X0 = b.X0;
+        X1 = b.X1;
+        Y0 = b.Y0;
+        Y1 = b.Y1;
+
+        while (nextPoint < points.size()) {
+            if (!events.empty() && event_first(events.top(), points[nextPoint].p)) {
+                process_event();
+            } else {
+                process_point();
+            }
+        }
+
+        while (!events.empty()) {
+            process_event();
+        }
+        Clock::time_point swept = stamp();
+
+        finish_edges();
+        if (buildHalfEdges) diagram.findFaces(n);
+
+        timing_.sites = points.size();
+        if (timed || counting) {
+            timing_.sort = seconds(start, sorted);
+            timing_.sweep = seconds(sorted, swept);
+            timing_.finish = seconds(swept, stamp());
+        }
+        FORTUNE_STAT(
+            stats_.siteEvents = timing_.sites;
+            stats_.circleEvents = timing_.circles;
+            stats_.sortSeconds = timing_.sort;
+            stats_.sweepSeconds = timing_.sweep;
+            stats_.finishSeconds = timing_.finish;
+        )
+    }
+
+    // The segments of the last build; empty when they were streamed to a sink.
+    const std::vector<Seg*> &segments() const { return output; }
+
+    BoundingBox bounds() const { return {X0, X1, Y0, Y1}; }
+
+    // The half-edges of the last build, if setHalfEdges() was on.
+    const HalfEdgeDiagram<T> &halfEdges() const { return diagram; }
+
+    // The Delaunay triangles of the last build, if setTriangles() was on:
+    // input indices of their corners, three per triangle, counterclockwise.
+    // Four or more cocircular sites are split into triangles arbitrarily.
+    const std::vector<int> &triangles() const { return triangles_; }
+
+    const Timing &timing() const { return timing_; }
+
+#ifdef FORTUNE_STATS
+    const SweepStats &stats() const { return stats_; }
+
+    // stats() as "name value" lines.
+    void printStats(std::ostream &out) const {
+        const SweepStats &s = stats_;
+        out << "fortune_site_events " << s.siteEvents << '\n'
+            << "fortune_circle_events " << s.circleEvents << '\n'
+            << "fortune_invalid_circle_events " << s.invalidEvents << '\n'
+            << "fortune_max_queue " << s.maxQueue << '\n'
+            << "fortune_max_front " << s.maxFront << '\n'
+            << "fortune_arcs_visited " << s.arcsVisited << '\n'
+            << "fortune_max_arcs_visited " << s.maxArcsVisited << '\n'
+            << "fortune_intersections " << s.intersections << '\n'
+            << "fortune_sort_seconds " << s.sortSeconds << '\n'
+            << "fortune_sweep_seconds " << s.sweepSeconds << '\n'
+            << "fortune_finish_seconds " << s.finishSeconds << '\n';
+    }
+#endif
+
+    // Bounding box followed by each output segment in four-column format.
+    // precision is as for SegmentWriter::setPrecision.
+    void printOutput(std::ostream &out, int precision = -1) const {
+        SegmentWriter writer(out);
+        writer.setPrecision(precision);
+        writer.writeRow(X0, X1, Y0, Y1);
+
+        for (const Seg *s : output) {
+            Point p0 = s->start;
+            Point p1 = s->end;
+            writer.writeRow(p0.x, p0.y, p1.x, p1.y);
+        }
+    }
+
+private:
+    struct Arc;
+
+    // Type of the arithmetic on coordinates.
+    typedef typename std::common_type<T, double>::type Real;
+    typedef std::pair<Real, Real> RealPoint;
+
+    struct Site {
+        Point p;
+        int index; // Position in the input.
+    };
+
+    struct Event {
+        T x;
+        Point p;
+        Arc *a;
+
+        Event(T xx, Point pp, Arc *aa) : x(xx), p(pp), a(aa) {}
+
+        bool operator<(const Event &o) const { return x < o.x; }
+    };
+
+    struct Arc {
+        Point p;
+        int site;
+        int upperSide; // side() of site number sideFor against the breakpoint with next.
+        Arc *prev, *next;
+        int queued; // Position of this Arc's circle Event in the queue, or -1.
+        bool red;   // Colour in the balanced tree over the front.
+
+        Seg *s0, *s1;
+
+        // Links of the balanced tree over the front, maintained by BeachLine.
+        Arc *parent, *left, *right;
+
+        // The parabola's terms with the sweep line at site number termsFor:
+        // 1/z, p.y/z and (p.x^2 + p.y^2 - l^2)/z, where z = 2 (p.x - l).
+        Real za, zb, zc;
+        std::size_t termsFor, sideFor;
+
+        Arc(Point pp, int ss)
+                : p(pp), site(ss), upperSide(0), prev(nullptr), next(nullptr), queued(-1), red(false),
+                  s0(nullptr), s1(nullptr), parent(nullptr), left(nullptr), right(nullptr), za(0), zb(0), zc(0),
+                  termsFor(0), sideFor(0) {}
+    };
+
+    // "Less than" comparison, for sorting the sites in sweep order.  Sites with
+    // equal x are swept bottom to top, as if the sweep line were tilted by an
+    // infinitesimal angle; no rotation of the input is needed.
+    struct lt {
+        bool operator()(const Site &a, const Site &b) const {
+            return a.p.x == b.p.x ? a.p.y < b.p.y : a.p.x < b.p.x;
+        }
+    };
+
+    BeachLine<Arc> front; // The parabolic front, in order of increasing y.
+
+    std::vector<Seg*> output;  // Array of output segments.
+    SegmentSink sink;          // Takes the place of output when set.
+
+    // Node storage for the current diagram, dropped as a whole by reset().
+    Arena<Arc> arcArena;
+
+    // Number of the site being inserted, which keys the caches of the arcs.
+    std::size_t siteCount = 0;
+    Arena<Seg> segArena;
+
+    // Bounding box coordinates.
+    T X0 = 0, X1 = 0, Y0 = 0, Y1 = 0;
+    BoundingBox fixedBox = {0, 0, 0, 0};
+    bool boxFixed = false; // Use fixedBox rather than fitting one.
+    bool integerSites = false;
+    bool buildHalfEdges = false;
+    HalfEdgeDiagram<T> diagram;
+    bool buildTriangles = false;
+    std::vector<int> triangles_;
+    bool timed = false;
+    Timing timing_ = {0, 0, 0, 0, 0};
+
+    typedef std::chrono::steady_clock Clock;
+
+    Clock::time_point stamp() const { return timed || counting ? Clock::now() : Clock::time_point(); }
+
+#ifdef FORTUNE_STATS
+    static constexpr bool counting = true;
+    SweepStats stats_ = {};
+    std::size_t frontArcs = 0;
+
+    void count_front(int change) {
+        frontArcs += change;
+        stats_.maxFront = std::max(stats_.maxFront, frontArcs);
+    }
+#else
+    static constexpr bool counting = false;
+#endif
+
+    static double seconds(Clock::time_point a, Clock::time_point b) {
+        return std::chrono::duration<double>(b - a).count();
+    }
+
+    std::vector<Site> points; // site events, sorted by lt
+    std::size_t nextPoint = 0; // First site not yet swept.
+    unsigned sortThreads = 1;
+    EventQueue<Event> events; // circle events
+
+    // Scratch for finish_edges.
+    std::vector<Arc*> openArcs;
+    std::vector<T> lanes;
+
+    void reset() {
+        front.clear();
+        output.clear();
+        arcArena.clear();
+        segArena.clear();
+        X0 = X1 = Y0 = Y1 = 0;
+        points.clear();
+        nextPoint = 0;
+        events.clear();
+        diagram.clear();
+        triangles_.clear();
+        timing_ = {0, 0, 0, 0, 0};
+        FORTUNE_STAT(stats_ = {}; frontArcs = 0;)
+    }
+
+    // New edge from p between the Arcs below and above it.  With half-edges
+    // on, `twin` is a half-edge of an edge this continues the other way from
+    // p, or -1 for a new edge.
+    Seg *new_seg(Point p, const Arc *lower, const Arc *upper, bool open = false, int twin = -1) {
+        Seg *s = segArena.make(p, upper->site, lower->site, open);
+        if (buildHalfEdges)
+            s->halfEdge = twin >= 0 ? HalfEdgeDiagram<T>::twin(twin) : diagram.addEdge(s->left, s->right);
+        if (!sink) output.push_back(s);
+        return s;
+    }
+
+    // Half-edge of a segment still to be finished, or -1.
+    static int open_half_edge(const Seg *s) { return s && !s->done ? s->halfEdge : -1; }
+
+    // Close s at p and hand it on if segments are streamed.  Nothing on the
+    // front refers to a closed segment, so its node can be reused.
+    void finish(Seg *s, Point p) {
+        if (s->done) return;
+        s->finish(p);
+
+        if (sink) {
+            sink(*s);
+            segArena.release(s);
+        }
+    }
+
+    // Breakpoint between the arcs of p0 (below) and p1 (above) with the sweep
+    // line at l.  A site on the sweep line is a degenerate arc, a horizontal ray
+    // through the site, and two arcs of equal x meet half way between them.
+    static RealPoint intersection(RealPoint p0, RealPoint p1, Real l) {
+        RealPoint res, p = p0;
+
+        if (p0.x == p1.x)
+            res.y = (p0.y + p1.y) / 2;
+        else if (p1.x == l)
+            res.y = p1.y;
+        else if (p0.x == l) {
+            res.y = p0.y;
+            p = p1;
+        } else {
+            // Use the quadratic formula.
+            Real z0 = 2*(p0.x - l);
+            Real z1 = 2*(p1.x - l);
+
+            Real a = 1/z0 - 1/z1;
+            Real b = -2*(p0.y/z0 - p1.y/z1);
+            Real c = (p0.y*p0.y + p0.x*p0.x - l*l)/z0
+                       - (p1.y*p1.y + p1.x*p1.x - l*l)/z1;
+
+            // Far from the sites the discriminant is a small difference of
+            // large terms and may come out just below zero.
+            Real d = b*b - 4*a*c;
+            res.y = ( -b - std::sqrt(d < 0 ? 0 : d) ) / (2*a);
+        }
+        // Plug back into one of the parabola equations.
+        res.x = (p.x*p.x + (p.y-res.y)*(p.y-res.y) - l*l)/(2*p.x-2*l);
+        return res;
+    }
+
+    // (bx[k], by[k]) = intersection((x0[k], y0[k]), (x1[k], y1[k]), l) for
+    // k < n, several at a time for doubles.
+    static void breakpoints(const double *x0, const double *y0, const double *x1, const double *y1,
+                            double l, double *bx, double *by, std::size_t n) {
+        SimdKernels::breakpoints(x0, y0, x1, y1, l, bx, by, n);
+    }
+
+    template <class U>
+    static void breakpoints(const U *x0, const U *y0, const U *x1, const U *y1,
+                            U l, U *bx, U *by, std::size_t n) {
+        for (std::size_t k = 0; k < n; ++k) {
+            RealPoint b = intersection(RealPoint(x0[k], y0[k]), RealPoint(x1[k], y1[k]), l);
+            bx[k] = b.x;
+            by[k] = b.y;
+        }
+    }
+
+    // Sign of p.y minus the y of the breakpoint between the arcs of lower and
+    // upper, with the sweep line at p.x.
+    int side(Point p, Arc *lower, Arc *upper) {
+        const Point &a = lower->p, &b = upper->p;
+        FORTUNE_STAT(++stats_.intersections;)
+        if (a.x == b.x || a.x == p.x || b.x == p.x) {
+            Real y = intersection(a, b, p.x).y;
+            return p.y < y ? -1 : p.y > y ? 1 : 0;
+        }
+        if (integerSites)
+            return exact_side(p, a, b);
+
+        // As in intersection(), from the terms of the two parabolas.
+        const Arc &s = terms(lower, p.x), &t = terms(upper, p.x);
+        Real qa = s.za - t.za, qb = -2*(s.zb - t.zb), qc = s.zc - t.zc;
+        Real d = qb*qb - 4*qa*qc;
+        Real y = ( -qb - std::sqrt(d < 0 ? 0 : d) ) / (2*qa);
+        return p.y < y ? -1 : p.y > y ? 1 : 0;
+    }
+
+    // The terms of Arc i with the sweep line at l, the x of the current site.
+    const Arc &terms(Arc *i, Real l) {
+        if (i->termsFor != siteCount) {
+            Real x = i->p.x, y = i->p.y, z = 2*(x - l);
+            i->za = 1/z;
+            i->zb = y/z;
+            i->zc = (y*y + x*x - l*l)/z;
+            i->termsFor = siteCount;
+        }
+        return *i;
+    }
+
+    // side() against the breakpoint between i and i->next.  The search for a
+    // site meets most breakpoints twice, once from either arc, so the answer
+    // is kept for the rest of the site's insertion.
+    int upper_side(Point p, Arc *i) {
+        if (i->sideFor != siteCount) {
+            i->upperSide = side(p, i, i->next);
+            i->sideFor = siteCount;
+        }
+        return i->upperSide;
+    }
+
+    // Does the horizontal ray from the new site p hit Arc i?  An arc whose
+    // site is also on the sweep line has no extent to hit.
+    bool intersect(Point p, Arc *i, Point *res) {
+        if (i->p.x == p.x) return false;
+
+        // Between the intersections of i->prev, i and of i, i->next.
+        if ((!i->prev || upper_side(p, i->prev) >= 0) && (!i->next || upper_side(p, i) <= 0)) {
+            res->y = p.y;
+
+            // Plug it back into the parabola equation.
+            Real x0 = i->p.x, y0 = i->p.y, l = p.x;
+            res->x = (x0*x0 + (y0-p.y)*(y0-p.y) - l*l) / (2*x0 - 2*l);
+
+            return true;
+        }
+        return false;
+    }
+
+    // (b - a) x (c - a), exact in sign for doubles.
+    static double turn(const std::pair<double, double> &a, const std::pair<double, double> &b,
+                       const std::pair<double, double> &c) {
+        return Predicates::orient(a.x, a.y, b.x, b.y, c.x, c.y);
+    }
+
+    template<class U>
+    static U turn(const std::pair<U, U> &a, const std::pair<U, U> &b, const std::pair<U, U> &c) {
+        return (b.x-a.x)*(c.y-a.y) - (c.x-a.x)*(b.y-a.y);
+    }
+
+    static bool circle(RealPoint a, RealPoint b, RealPoint c, Real *x, RealPoint *o) {
+        // Check that bc is a "right turn" from ab; co-linear points have no circle.
+        Real t = turn(a, b, c);
+        if (t >= 0)
+            return false;
+
+        // Algorithm from O'Rourke 2ed p. 189, with G from the turn.
+        Real A = b.x - a.x,  B = b.y - a.y,
+                C = c.x - a.x,  D = c.y - a.y,
+                E = A*(a.x+b.x) + B*(a.y+b.y),
+                F = C*(a.x+c.x) + D*(a.y+c.y),
+                G = 2*t;
+
+        // Point o is the center of the circle.
+        o->x = (D*E-B*F)/G;
+        o->y = (A*F-C*E)/G;
+
+        // o.x plus radius equals max x coordinate.
+        Real dx = a.x - o->x, dy = a.y - o->y;
+        *x = o->x + std::sqrt(dx*dx + dy*dy);
+        return true;
+    }
+
+    // Does Event e come before a site at p, or with it?
+    bool event_first(const Event &e, const Point &p) const {
+        if (!integerSites) return e.x <= p.x;
+        return exact_circle_right(e.a->prev->p, e.a->p, e.a->next->p, p.x) <= 0;
+    }
+
+#ifdef FORTUNE_EXACT_PREDICATES
+    static bool on_grid(T v) {
+        return std::trunc(v) == v && std::fabs(v) <= static_cast<T>(Predicates::limit);
+    }
+
+    static Predicates::Int whole(T v) { return static_cast<Predicates::Int>(v); }
+
+    static int exact_side(const Point &p, const Point &a, const Point &b) {
+        return Predicates::breakpointSide(whole(a.x), whole(a.y), whole(b.x), whole(b.y), whole(p.x), whole(p.y));
+    }
+
+    static int exact_circle_right(const Point &a, const Point &b, const Point &c, T x) {
+        return Predicates::circleRight(whole(a.x), whole(a.y), whole(b.x), whole(b.y), whole(c.x), whole(c.y),
+                                       whole(x));
+    }
+
+    // circle() for integer sites: the turn is decided exactly, and the
+    // center rounded once from its exact numerators.
+    static bool exact_circle(const Point &a, const Point &b, const Point &c, Real *x, RealPoint *o) {
+        if (Predicates::orient(whole(a.x), whole(a.y), whole(b.x), whole(b.y), whole(c.x), whole(c.y)) >= 0)
+            return false;
+        Predicates::Int128 nx, ny, q;
+        Predicates::circumcenter(whole(a.x), whole(a.y), whole(b.x), whole(b.y), whole(c.x), whole(c.y),
+                                 &nx, &ny, &q);
+        Real ux = static_cast<Real>(nx) / static_cast<Real>(q), uy = static_cast<Real>(ny) / static_cast<Real>(q);
+        o->x = a.x + ux;
+        o->y = a.y + uy;
+        *x = o->x + std::sqrt(ux*ux + uy*uy);
+        return true;
+    }
+#else
+    // Never called: setIntegerSites() refuses to turn them on.
+    static bool on_grid(T) { return false; }
+    static int exact_side(const Point &, const Point &, const Point &) { return 0; }
+    static int exact_circle_right(const Point &, const Point &, const Point &, T) { return 0; }
+    static bool exact_circle(const Point &, const Point &, const Point &, Real *, RealPoint *) { return false; }
+#endif
+
+    void check_circle_event(Arc *i, T x0) {
+        // An Event due at the current position is kept: it fires next.
+        if (events.contains(i) && events.of(i).x == x0)
+            return;
+
+        Real x;
+        RealPoint o;
+
+        // Converging breakpoints meet at or beyond the sweep line, so an x
+        // behind it (sites on one circle, or on the sweep line itself) is
+        // rounding error and the Event is due now.
+        FORTUNE_STAT(if (events.contains(i)) ++stats_.invalidEvents;)
+        if (i->prev && i->next && (integerSites ? exact_circle(i->prev->p, i->p, i->next->p, &x, &o)
+                                                : circle(i->prev->p, i->p, i->next->p, &x, &o)))
+            events.set(Event(std::max<Real>(x, x0), o, i)); // Replaces any old Event of i.
+        else
+            events.remove(i);
+        FORTUNE_STAT(stats_.maxQueue = std::max(stats_.maxQueue, events.size());)
+    }
+
+    void front_insert(const Site &site) {
+        Point p = site.p;
+        ++siteCount;
+        if (front.empty()) {
+            front.insertAfter(nullptr, arcArena.make(p, site.index));
+            FORTUNE_STAT(count_front(1);)
+            return;
+        }
+
+        // Find the current Arc at height p.y by descending through the breakpoints
+        // at sweep position p.x.  A site exactly on a breakpoint resolves to the
+        // lower of the two arcs.
+        FORTUNE_STAT(std::size_t visited = 0;)
+        Arc *i = front.find([&](Arc *a) {
+            FORTUNE_STAT(++visited;)
+            if (a->prev && upper_side(p, a->prev) <= 0) return -1;
+            if (a->next && upper_side(p, a) > 0) return 1;
+            return 0;
+        });
+        FORTUNE_STAT(
+            stats_.arcsVisited += visited;
+            stats_.maxArcsVisited = std::max(stats_.maxArcsVisited, visited);
+        )
+
+        Point z, zz;
+        if (intersect(p, i, &z)) {
+            // New parabola intersects Arc i.  If necessary, duplicate i.
+            bool split = !i->next || !intersect(p, i->next, &zz);
+            int ended = -1;
+            if (split) {
+                Arc *copy = arcArena.make(i->p, i->site);
+                front.insertAfter(i, copy);
+                copy->s1 = i->s1;
+            } else if (i->s1) {
+                // p lies exactly on the breakpoint between i and i->next.
+                ended = open_half_edge(i->s1);
+                finish(i->s1, z);
+            }
+
+            // Add p between i and i->next.
+            front.insertAfter(i, arcArena.make(p, site.index));
+            FORTUNE_STAT(count_front(split ? 2 : 1);)
+
+            i = i->next; // Now i points to the new Arc.
+
+            // Add new half-edges connected to i's endpoints.  When i was
+            // split they are the two ends of one edge, else z is a vertex.
+            i->prev->s1 = i->s0 = new_seg(z, i->prev, i);
+            i->next->s0 = i->s1 = new_seg(z, i, i->next, false, split ? i->s0->halfEdge : -1);
+            if (buildHalfEdges && !split) diagram.join(z, ended, -1, i->s0->halfEdge, i->s1->halfEdge);
+            if (buildTriangles && !split) triangles_.insert(triangles_.end(), {i->prev->site, i->site, i->next->site});
+
+            // Check for new circle events around the new Arc:
+            check_circle_event(i, p.x);
+            check_circle_event(i->prev, p.x);
+            check_circle_event(i->next, p.x);
+
+            return;
+        }
+
+        // Special case: every Arc so far belongs to the first column of sites,
+        // which share p.x.  They are swept bottom to top, so p goes on top.
+        i = front.last();
+        front.insertAfter(i, arcArena.make(p, site.index));
+        FORTUNE_STAT(count_front(1);)
+
+        // Insert segment between p and i: a ray coming in from x = -infinity,
+        // started as far left as finish_edges() ends the rays on the right.
+        Point start;
+        start.x = X0 - (X1-X0) - (Y1-Y0);
+        start.y = (i->next->p.y + i->p.y) / 2;
+        i->s1 = i->next->s0 = new_seg(start, i, i->next, true);
+    }
+
+    void process_event() {
+        // Get the next Event from the queue.  Every queued Event is live.
+        Event e = events.top();
+        events.pop();
+        ++timing_.circles;
+
+        // Start a new edge.
+        Seg *s = new_seg(e.p, e.a->prev, e.a->next);
+
+        // Remove the associated Arc from the front.  a->prev and a->next
+        // still refer to its former neighbours afterwards.
+        Arc *a = e.a;
+        front.erase(a);
+        FORTUNE_STAT(count_front(-1);)
+        if (a->prev) a->prev->s1 = s;
+        if (a->next) a->next->s0 = s;
+        if (buildHalfEdges) diagram.join(e.p, open_half_edge(a->s0), open_half_edge(a->s1), s->halfEdge, -1);
+
+        // The three sites on the circle make a right turn on the front.
+        if (buildTriangles) triangles_.insert(triangles_.end(), {a->prev->site, a->next->site, a->site});
+
+        // Finish the edges before and after a.
+        if (a->s0) finish(a->s0, e.p);
+        if (a->s1) finish(a->s1, e.p);
+
+        // Recheck circle events on either side of p:
+        if (a->prev) check_circle_event(a->prev, e.x);
+        if (a->next) check_circle_event(a->next, e.x);
+    }
+
+    void process_point() {
+        // Get the next Site in sweep order.
+        const Site &site = points[nextPoint++];
+
+        // Add a new Arc to the parabolic front.
+        front_insert(site);
+    }
+
+    void finish_edges() {
+        if (front.empty()) return;
+
+        // Advance the sweep line so no parabolas can cross the bounding box.
+        T l = X1 + (X1-X0) + (Y1-Y0);
+
+        // Extend each remaining segment to the new parabola intersections,
+        // all found in one batch.
+        openArcs.clear();
+        for (Arc *i = front.first(); i->next; i = i->next)
+            if (i->s1) openArcs.push_back(i);
+        std::size_t n = openArcs.size();
+        lanes.resize(6 * n);
+        T *x0 = lanes.data(), *y0 = x0 + n, *x1 = y0 + n, *y1 = x1 + n, *ends = y1 + n;
+        for (std::size_t k = 0; k < n; ++k) {
+            const Arc *i = openArcs[k];
+            x0[k] = i->p.x;
+            y0[k] = i->p.y;
+            x1[k] = i->next->p.x;
+            y1[k] = i->next->p.y;
+        }
+        breakpoints(x0, y0, x1, y1, l*2, ends, ends + n, n);
+        FORTUNE_STAT(stats_.intersections += n;)
+
+        for (std::size_t k = 0; k < n; ++k) {
+            const Arc *i = openArcs[k];
+            Seg *s = i->s1;
+
+            Point p0 = i->p, p1 = i->next->p;
+            Point end(ends[k], ends[n + k]);
+
+            // The breakpoint runs along (p1.y - p0.y, p0.x - p1.x) as the sweep
+            // advances.  A vertex of nearly collinear sites can lie beyond l,
+            // so check that the edge was not extended backwards, and if it
+            // was, go as far past where the breakpoint leaves the vertex.
+            // That depends on the edge alone, so builds over parts of the
+            // sites end it like a build over all of them.
+            if ((end.x - s->start.x)*(p1.y - p0.y) + (end.y - s->start.y)*(p0.x - p1.x) < 0) {
+                Real past = s->start.x + std::hypot(Real(s->start.x - p0.x), Real(s->start.y - p0.y));
+                end = intersection(p0, p1, (std::max<Real>(X1, past) + (X1-X0) + (Y1-Y0))*2);
+                FORTUNE_STAT(++stats_.intersections;)
+            }
+            s->openEnd = true;
+            finish(s, end);
+        }
+    }
+};
+
+
+typedef BasicVoronoiBuilder<double> VoronoiBuilder;
+
+
+#undef x
+#undef y
+#undef FORTUNE_STAT
+
+
+#endif //FORTUNE_VORONOIBUILDER_H
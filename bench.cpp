@@ -0,0 +1,335 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+#include <vector>
+#include "PointGenerator.h"
+#include "VoronoiBuilder.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+
+// Usage: fortune_bench [-n sizes] [-d distributions] [-e engines] [-r repetitions] [-s seed]
+//                      [-o results.json]
+//
+// Times each phase of a build for every combination of size, distribution
+// and engine, and prints a table; -o also writes the results as JSON ("-" for
+// standard output, which then leaves the table to standard error).  Lists
+// are comma separated.
+//   sizes          default 1e2,1e3,1e4,1e5,1e6,1e7
+//   distributions  uniform, clustered, grid, jittered, poisson, circle,
+//                  collinear (default all)
+//   engines        double, float, exact (integer sites; default double)
+//   repetitions    default 5
+//   seed           of PointGenerator, default 1
+// Each case runs in a process of its own where fork() is available, so that
+// its peak resident set is its own.  Build with optimization.  Built with
+// FORTUNE_STATS, it also dumps the sweep counters of each case's last build
+// to standard error.
+
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+double since(Clock::time_point t) {
+    return std::chrono::duration<double>(Clock::now() - t).count();
+}
+
+const char *const distributions[] = {"uniform", "clustered", "grid", "jittered", "poisson", "circle", "collinear"};
+
+// About n sites of distribution `dist` in the square [0, 1000]^2, the same
+// for the same arguments.
+std::vector<std::pair<double, double>> makeSites(const std::string &dist, std::size_t n, std::uint64_t seed) {
+    PointGenerator gen(seed);
+    int num = static_cast<int>(n);
+
+    if (dist == "uniform") return gen.generatePoints(num, 0, 1000, 0, 1000);
+    if (dist == "clustered") {
+        // About a hundred sites around each center.
+        int k = std::max(1, num / 100);
+        return gen.generateClusters(num, k, 1000 / (4 * std::sqrt(static_cast<double>(k))), 0, 1000, 0, 1000);
+    }
+    if (dist == "grid") return gen.generateJitteredGrid(num, 0, 0, 1000, 0, 1000);
+    if (dist == "jittered") return gen.generateJitteredGrid(num, 0.5, 0, 1000, 0, 1000);
+    if (dist == "poisson") return gen.generatePoissonDisk(1000 * std::sqrt(0.67 / static_cast<double>(n)), 0, 1000, 0, 1000);
+
+    std::vector<std::pair<double, double>> sites;
+    if (dist == "circle") {
+        const double pi = 3.14159265358979323846;
+        sites = gen.generatePoints(num, 0, 2 * pi, 0, 1);
+        for (auto &p : sites) p = {500 + 400 * std::cos(p.first), 500 + 400 * std::sin(p.first)};
+    } else if (dist == "collinear") {
+        // Along a diagonal, each moved off it by up to half a millionth.
+        sites = gen.generatePoints(num, 0, 1000, -0.5e-6, 0.5e-6);
+        for (auto &p : sites) p = {p.first, p.first / 2 + 250 + p.second};
+    } else {
+        throw std::runtime_error("Unknown distribution " + dist + ".");
+    }
+    return sites;
+}
+
+// Swallows the text output.
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return c; }
+    std::streamsize xsputn(const char *, std::streamsize n) override { return n; }
+};
+
+long peakKilobytes() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS pmc;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof pmc)) return -1;
+    return static_cast<long>(pmc.PeakWorkingSetSize / 1024);
+#else
+    rusage r;
+    if (getrusage(RUSAGE_SELF, &r)) return -1;
+#ifdef __APPLE__
+    return static_cast<long>(r.ru_maxrss / 1024);
+#else
+    return static_cast<long>(r.ru_maxrss);
+#endif
+#endif
+}
+
+struct Phases {
+    double input = 0, sort = 0, sweep = 0, finish = 0, output = 0;
+};
+
+struct Result {
+    std::string engine, dist;
+    std::size_t n = 0, sites = 0, reps = 0, segments = 0, events = 0;
+    Phases mean;
+    double nsMean = 0, nsStddev = 0, nsMin = 0, eventsPerSecond = 0;
+    long peakKb = -1;
+};
+
+template <class T>
+Result runCase(const std::string &engine, const std::string &dist, std::size_t n, std::size_t reps,
+               std::uint64_t seed, bool exact) {
+    typedef BasicVoronoiBuilder<T> Builder;
+    Builder builder;
+    builder.setTiming(true);
+    builder.setIntegerSites(exact);
+    NullBuffer null;
+    std::ostream discard(&null);
+
+    Result r;
+    r.engine = engine;
+    r.dist = dist;
+    r.n = n;
+    r.reps = reps;
+    std::vector<double> ns;
+    double sweepSeconds = 0;
+    for (std::size_t rep = 0; rep < reps; ++rep) {
+        Clock::time_point t = Clock::now();
+        std::vector<std::pair<double, double>> generated = makeSites(dist, n, seed);
+        std::vector<typename Builder::Point> sites(generated.size());
+        r.sites = sites.size();
+        for (std::size_t k = 0; k < sites.size(); ++k) {
+            // Integer sites on a grid a thousand times finer.
+            if (exact)
+                sites[k] = {static_cast<T>(std::round(generated[k].first * 1000)),
+                            static_cast<T>(std::round(generated[k].second * 1000))};
+            else
+                sites[k] = {static_cast<T>(generated[k].first), static_cast<T>(generated[k].second)};
+        }
+        std::vector<std::pair<double, double>>().swap(generated);
+        r.mean.input += since(t);
+
+        t = Clock::now();
+        builder.build(sites);
+        ns.push_back(since(t) * 1e9 / static_cast<double>(std::max<std::size_t>(r.sites, 1)));
+        const typename Builder::Timing &timing = builder.timing();
+        r.mean.sort += timing.sort;
+        r.mean.sweep += timing.sweep;
+        r.mean.finish += timing.finish;
+        sweepSeconds += timing.sweep;
+        r.events = timing.sites + timing.circles;
+        r.segments = builder.segments().size();
+
+        t = Clock::now();
+        builder.printOutput(discard);
+        r.mean.output += since(t);
+    }
+
+    double k = static_cast<double>(reps);
+    r.mean.input /= k;
+    r.mean.sort /= k;
+    r.mean.sweep /= k;
+    r.mean.finish /= k;
+    r.mean.output /= k;
+    for (double v : ns) r.nsMean += v / k;
+    for (double v : ns) r.nsStddev += (v - r.nsMean) * (v - r.nsMean) / k;
+    r.nsStddev = std::sqrt(r.nsStddev);
+    r.nsMin = *std::min_element(ns.begin(), ns.end());
+    r.eventsPerSecond = sweepSeconds > 0 ? static_cast<double>(r.events) * k / sweepSeconds : 0;
+    r.peakKb = peakKilobytes();
+#ifdef FORTUNE_STATS
+    std::cerr << "# " << engine << ' ' << dist << ' ' << n << '\n';
+    builder.printStats(std::cerr);
+#endif
+    return r;
+}
+
+Result runCase(const std::string &engine, const std::string &dist, std::size_t n, std::size_t reps,
+               std::uint64_t seed) {
+    if (engine == "double") return runCase<double>(engine, dist, n, reps, seed, false);
+    if (engine == "float") return runCase<float>(engine, dist, n, reps, seed, false);
+    if (engine == "exact") return runCase<double>(engine, dist, n, reps, seed, true);
+    throw std::runtime_error("Unknown engine " + engine + ".");
+}
+
+// The result as one line of JSON.
+std::string toJson(const Result &r) {
+    std::ostringstream o;
+    o.precision(6);
+    o << "{\"engine\": \"" << r.engine << "\", \"distribution\": \"" << r.dist << "\", \"n\": " << r.n
+      << ", \"sites\": " << r.sites << ", \"repetitions\": " << r.reps << ", \"segments\": " << r.segments << ", \"events\": " << r.events
+      << ", \"ns_per_site\": {\"mean\": " << r.nsMean << ", \"stddev\": " << r.nsStddev << ", \"min\": " << r.nsMin
+      << "}, \"phases_seconds\": {\"input\": " << r.mean.input << ", \"sort\": " << r.mean.sort
+      << ", \"sweep\": " << r.mean.sweep << ", \"finish_edges\": " << r.mean.finish
+      << ", \"output\": " << r.mean.output << "}, \"events_per_second\": " << r.eventsPerSecond
+      << ", \"peak_rss_kb\": " << r.peakKb << "}";
+    return o.str();
+}
+
+#ifndef _WIN32
+// Run the case in a child process and pass its result back through a pipe.
+std::string runIsolated(const std::string &engine, const std::string &dist, std::size_t n, std::size_t reps,
+                        std::uint64_t seed) {
+    int fds[2];
+    if (pipe(fds)) throw std::runtime_error("pipe() failed.");
+    std::cout.flush();
+    pid_t child = fork();
+    if (child < 0) throw std::runtime_error("fork() failed.");
+    if (child == 0) {
+        close(fds[0]);
+        int status = 0;
+        std::string json;
+        try {
+            json = toJson(runCase(engine, dist, n, reps, seed));
+        } catch (const std::exception &e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            status = 1;
+        }
+        for (std::size_t done = 0; done < json.size();) {
+            ssize_t w = write(fds[1], json.data() + done, json.size() - done);
+            if (w <= 0) break;
+            done += static_cast<std::size_t>(w);
+        }
+        close(fds[1]);
+        _exit(status);
+    }
+    close(fds[1]);
+    std::string json;
+    char buf[4096];
+    for (ssize_t got; (got = read(fds[0], buf, sizeof buf)) > 0;) json.append(buf, static_cast<std::size_t>(got));
+    close(fds[0]);
+    int status = 0;
+    waitpid(child, &status, 0);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0 || json.empty())
+        throw std::runtime_error("Case " + engine + " " + dist + " " + std::to_string(n) + " failed.");
+    return json;
+}
+#endif
+
+std::vector<std::string> split(const std::string &list) {
+    std::vector<std::string> parts;
+    std::stringstream in(list);
+    for (std::string s; std::getline(in, s, ',');)
+        if (!s.empty()) parts.push_back(s);
+    return parts;
+}
+
+// Looks up a number in a line from toJson().
+double field(const std::string &json, const std::string &key) {
+    std::size_t at = json.find("\"" + key + "\": ");
+    return at == std::string::npos ? 0 : std::strtod(json.c_str() + at + key.size() + 4, nullptr);
+}
+
+}
+
+
+int main(int argc, char *argv[])
+{
+    std::vector<std::string> sizes = {"1e2", "1e3", "1e4", "1e5", "1e6", "1e7"};
+    std::vector<std::string> dists(std::begin(distributions), std::end(distributions));
+    std::vector<std::string> engines = {"double"};
+    std::size_t reps = 5;
+    std::uint64_t seed = 1;
+    std::string jsonPath;
+
+    try {
+        for (int a = 1; a < argc; ++a) {
+            std::string opt = argv[a];
+            if (a + 1 >= argc) throw std::runtime_error(opt + " needs a value.");
+            std::string value = argv[++a];
+            if (opt == "-n") sizes = split(value);
+            else if (opt == "-d") dists = split(value);
+            else if (opt == "-e") engines = split(value);
+            else if (opt == "-r") reps = std::max(1, std::atoi(value.c_str()));
+            else if (opt == "-s") seed = std::strtoull(value.c_str(), nullptr, 10);
+            else if (opt == "-o") jsonPath = value;
+            else throw std::runtime_error("Unknown option " + opt + ".");
+        }
+
+        std::FILE *table = jsonPath == "-" ? stderr : stdout;
+        std::fprintf(table, "%-7s %-10s %9s %9s %8s %8s %8s %8s %8s %8s %11s %9s\n", "engine", "dist", "sites",
+                     "ns/site", "+-", "input", "sort", "sweep", "finish", "output", "events/s", "peak MB");
+        std::vector<std::string> results;
+        for (const std::string &engine : engines)
+            for (const std::string &dist : dists)
+                for (const std::string &size : sizes) {
+                    std::size_t n = static_cast<std::size_t>(std::strtod(size.c_str(), nullptr));
+                    if (!n) throw std::runtime_error("Bad size " + size + ".");
+#ifdef _WIN32
+                    std::string json = toJson(runCase(engine, dist, n, reps, seed));
+#else
+                    std::string json = runIsolated(engine, dist, n, reps, seed);
+#endif
+                    results.push_back(json);
+                    std::fprintf(table, "%-7s %-10s %9.0f %9.1f %8.1f %8.4f %8.4f %8.4f %8.4f %8.4f %11.4g %9.1f\n",
+                                 engine.c_str(), dist.c_str(), field(json, "sites"), field(json, "mean"), field(json, "stddev"),
+                                 field(json, "input"), field(json, "sort"), field(json, "sweep"),
+                                 field(json, "finish_edges"), field(json, "output"),
+                                 field(json, "events_per_second"), field(json, "peak_rss_kb") / 1024);
+                    std::fflush(table);
+                }
+
+        if (!jsonPath.empty()) {
+            std::ofstream file;
+            if (jsonPath != "-") file.open(jsonPath);
+            std::ostream &out = jsonPath == "-" ? std::cout : file;
+            if (!out) throw std::runtime_error("Cannot write " + jsonPath + ".");
+            out << "[\n";
+            for (std::size_t k = 0; k < results.size(); ++k)
+                out << "  " << results[k] << (k + 1 < results.size() ? ",\n" : "\n");
+            out << "]\n";
+        }
+    } catch (const std::runtime_error &e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
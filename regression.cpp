@@ -0,0 +1,350 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <utility>
+#include <vector>
+#include "BatchBuilder.h"
+#include "CellPolygons.h"
+#include "DynamicVoronoi.h"
+#include "ParallelBuilder.h"
+#include "PointGenerator.h"
+#include "TiledBuilder.h"
+#include "VoronoiBuilder.h"
+
+
+// Regression tests for bugs the sweep once had.  Each test returns whether
+// it passed; main() runs them all and fails if any did.
+
+static bool check(bool ok, const char *what) {
+    if (!ok) std::cerr << "FAILED: " << what << '\n';
+    return ok;
+}
+
+// The edges of triangles t, each as its smaller index first, sorted.
+static std::vector<std::pair<int, int>> edgesOf(const std::vector<int> &t) {
+    std::vector<std::pair<int, int>> e;
+    for (std::size_t k = 0; k < t.size(); k += 3)
+        for (int j = 0; j < 3; ++j)
+            e.emplace_back(std::min(t[k + j], t[k + (j + 1) % 3]), std::max(t[k + j], t[k + (j + 1) % 3]));
+    std::sort(e.begin(), e.end());
+    e.erase(std::unique(e.begin(), e.end()), e.end());
+    return e;
+}
+
+// How many of `want` are not in `have`, both sorted.
+static std::size_t missing(const std::vector<std::pair<int, int>> &have,
+                           const std::vector<std::pair<int, int>> &want) {
+    std::vector<std::pair<int, int>> d;
+    std::set_difference(want.begin(), want.end(), have.begin(), have.end(), std::back_inserter(d));
+    return d.size();
+}
+
+typedef std::map<std::pair<VoronoiBuilder::Point, VoronoiBuilder::Point>, double> EdgeLengths;
+
+// Add the length of s to the edge between its sites, named by position so
+// that duplicates swept under different indices agree.
+static void addLength(EdgeLengths &m, const std::vector<VoronoiBuilder::Point> &sites, const VoronoiBuilder::Seg &s,
+                      double share = 1) {
+    VoronoiBuilder::Point a = sites[s.left], b = sites[s.right];
+    if (b < a) std::swap(a, b);
+    m[{a, b}] += share * std::hypot(s.end.first - s.start.first, s.end.second - s.start.second);
+}
+
+static EdgeLengths sweptLengths(const std::vector<VoronoiBuilder::Point> &sites) {
+    VoronoiBuilder b;
+    b.build(sites);
+    EdgeLengths m;
+    for (const VoronoiBuilder::Seg *s : b.segments()) addLength(m, sites, *s);
+    return m;
+}
+
+// Whether every edge has the same length in both, up to rounding.
+static bool sameLengths(const EdgeLengths &a, const EdgeLengths &b) {
+    auto near = [](const EdgeLengths &m, const EdgeLengths &n) {
+        for (const auto &e : m) {
+            auto f = n.find(e.first);
+            double other = f == n.end() ? 0 : f->second;
+            if (std::abs(e.second - other) > 1e-6 * std::max(1.0, e.second)) return false;
+        }
+        return true;
+    };
+    return near(a, b) && near(b, a);
+}
+
+// The float engine squared coordinates in float before deciding which side
+// of a breakpoint a site falls on, and put sites on the wrong arc: thousands
+// of Delaunay edges went missing and triangles overlapped.  It must now
+// triangulate float sites like the double engine does, but for the odd
+// nearly cocircular four, as it keeps the times of circle events in float.
+static bool floatMatchesDouble() {
+    typedef BasicVoronoiBuilder<float> FloatBuilder;
+    std::vector<FloatBuilder::Point> sites = PointGenerator(1).generatePoints<float>(200000, 0, 1000, 0, 1000);
+    std::vector<VoronoiBuilder::Point> wide(sites.begin(), sites.end());
+
+    FloatBuilder f;
+    f.setTriangles(true);
+    f.build(sites);
+    VoronoiBuilder d;
+    d.setTriangles(true);
+    d.build(wide);
+
+    double area = 0;
+    bool ccw = true;
+    const std::vector<int> &t = f.triangles();
+    for (std::size_t k = 0; k < t.size(); k += 3) {
+        const VoronoiBuilder::Point &a = wide[t[k]], &b = wide[t[k + 1]], &c = wide[t[k + 2]];
+        double twice = (b.first - a.first) * (c.second - a.second) - (b.second - a.second) * (c.first - a.first);
+        ccw = ccw && twice > 0;
+        area += twice / 2;
+    }
+    double expected = 0;
+    for (std::size_t k = 0; k < d.triangles().size(); k += 3) {
+        const VoronoiBuilder::Point &a = wide[d.triangles()[k]], &b = wide[d.triangles()[k + 1]],
+                &c = wide[d.triangles()[k + 2]];
+        expected += ((b.first - a.first) * (c.second - a.second) - (b.second - a.second) * (c.first - a.first)) / 2;
+    }
+
+    return check(t.size() == d.triangles().size(), "float engine: as many triangles as double")
+           & check(ccw, "float engine: every triangle counterclockwise")
+           & check(std::abs(area - expected) < 1e-6 * expected, "float engine: triangles cover the hull once")
+           & check(missing(edgesOf(t), edgesOf(d.triangles())) <= t.size() / 3 / 10000,
+                   "float engine: the Delaunay edges of double");
+}
+
+// Edges between sites of a shared leftmost column are rays from x = -infinity.
+// Those whose vertex lay left of the box were collapsed onto the vertex, so
+// they never reached it.  They must start left of the box, halfway between
+// their sites.
+static bool leftColumnRays() {
+    std::vector<VoronoiBuilder::Point> sites = {{0, 0}, {0, 9}, {3, 3}, {3, 6}, {3, 9}};
+    VoronoiBuilder b;
+    b.build(sites);
+
+    int rays = 0;
+    bool left = true, between = true;
+    for (const VoronoiBuilder::Seg *s : b.segments()) {
+        if (!s->openStart) continue;
+        ++rays;
+        left = left && s->start.first < b.bounds().X0 && s->start.first < s->end.first;
+        between = between && s->start.second == (sites[s->left].second + sites[s->right].second) / 2;
+    }
+    return check(rays == 1, "left column: one ray between the sites at x = 0")
+           & check(left, "left column: rays start left of the box")
+           & check(between, "left column: rays run halfway between their sites");
+}
+
+// Rays whose vertex lies beyond the line finish_edges() extends to were
+// ended relative to the last event of the sweep, which differs between the
+// slabs of ParallelBuilder and a single build.  A row of collinear sites
+// along the hull makes such rays.
+static bool parallelRaysMatch() {
+    std::vector<VoronoiBuilder::Point> sites = PointGenerator(5).generatePoints(4000, 0, 1000, 0, 1000);
+    for (int k = 0; k < 200; ++k) sites.emplace_back(5.0 * k, -1.0);
+    VoronoiBuilder b;
+    b.build(sites);
+    std::map<std::pair<int, int>, VoronoiBuilder::Point> ends;
+    for (const VoronoiBuilder::Seg *s : b.segments())
+        if (s->openEnd) ends[{s->left, s->right}] = s->end;
+
+    ParallelBuilder p(4);
+    p.setMinSlabSites(200);
+    p.build(sites);
+    std::size_t rays = 0, same = 0;
+    for (const VoronoiBuilder::Seg &s : p.segments()) {
+        if (!s.openEnd) continue;
+        ++rays;
+        auto e = ends.find({s.left, s.right});
+        same += e != ends.end() && e->second == s.end;
+    }
+    return check(rays == ends.size() && same == rays, "parallel build: rays end where a single build ends them");
+}
+
+// The cells of a diagram clipped to its box must tile the box.  When all
+// sites are collinear the cells between the ends are strips, and only one
+// of their two sides was clipped, so the cells overlapped.
+static bool cellsTileBox() {
+    typedef CellPolygons<double> Cells;
+    std::vector<std::vector<VoronoiBuilder::Point>> cases = {
+            {{0, 0}, {1, 0}, {2, 0}, {3, 0}},         // A row,
+            {{0, 0}, {0, 1}, {0, 2}, {0, 3}, {0, 4}}, // a column,
+            {{0, 0}, {1, 1}, {2, 2}, {4, 4}},         // a diagonal,
+            {{1, 2}, {3, 1}},                         // two sites,
+            {{5, 5}},                                 // one,
+            PointGenerator(2).generatePoints(2000, 0, 1000, 0, 1000)};
+    bool ok = true;
+    for (const std::vector<VoronoiBuilder::Point> &sites : cases) {
+        VoronoiBuilder b;
+        b.setHalfEdges(true);
+        b.build(sites);
+        VoronoiBuilder::BoundingBox box = b.bounds();
+        Cells cells;
+        cells.build(b.halfEdges(), sites.data(), sites.size(), Cells::rectangle(box.X0, box.X1, box.Y0, box.Y1));
+
+        double area = 0;
+        for (const Cells::Cell &cell : cells.cells())
+            for (std::size_t k = cell.begin; k < cell.end; ++k) {
+                const Cells::Point &p = cells.vertices()[k];
+                const Cells::Point &q = cells.vertices()[k + 1 == cell.end ? cell.begin : k + 1];
+                area += (p.first * q.second - q.first * p.second) / 2;
+            }
+        double expected = (box.X1 - box.X0) * (box.Y1 - box.Y0);
+        ok = check(std::abs(area - expected) < 1e-9 * expected, "cell polygons: cells tile the box") && ok;
+    }
+    return ok;
+}
+
+// TiledBuilder must give every cell the edges of a single sweep, including
+// the cells of duplicate sites and of sites on the lines between tiles.
+static bool tiledMatchesSweep() {
+    // A lattice puts sites on the tile boundaries; a few are doubled.
+    std::vector<VoronoiBuilder::Point> sites = PointGenerator(3).generatePoints(3000, 0, 40, 0, 40);
+    for (int i = 0; i <= 40; i += 2)
+        for (int j = 0; j <= 40; j += 2) sites.emplace_back(i, j);
+    for (std::size_t k = 0; k < sites.size(); k += 97) sites.push_back(sites[k]);
+
+    TiledBuilder t(4);
+    t.setTileSites(200);
+    t.build(sites);
+    EdgeLengths tiled;
+    for (const TiledBuilder::Cell &c : t.cells())
+        for (std::size_t e = c.begin; e < c.end; ++e) addLength(tiled, sites, t.edges()[e], 0.5);
+    std::vector<VoronoiBuilder::Point> distinct(sites);
+    std::sort(distinct.begin(), distinct.end());
+    distinct.erase(std::unique(distinct.begin(), distinct.end()), distinct.end());
+    return check(t.cells().size() == distinct.size(), "tiled build: one cell per distinct site")
+           & check(sameLengths(tiled, sweptLengths(sites)), "tiled build: the edges of a single sweep");
+}
+
+// One BatchBuilder, reused across calls with batches of different sizes,
+// must give every diagram the segments and box of a build of its own.
+static bool batchMatchesSingle() {
+    BatchBuilder batch(4);
+    PointGenerator gen(4);
+    bool ok = true;
+    for (std::size_t diagrams : {300, 7, 0, 1000}) {
+        std::vector<VoronoiBuilder::Point> sites;
+        std::vector<std::size_t> offsets = {0};
+        for (std::size_t d = 0; d < diagrams; ++d) {
+            int n = d % 13 == 0 ? 0 : d % 11 == 0 ? 1 : static_cast<int>(d % 97 + 2);
+            std::vector<VoronoiBuilder::Point> part = gen.generatePoints(n, 0, 100, 0, 100);
+            sites.insert(sites.end(), part.begin(), part.end());
+            offsets.push_back(sites.size());
+        }
+        batch.build(sites, offsets);
+
+        bool offsetsOk = batch.segmentOffsets().size() == diagrams + 1, same = true;
+        for (std::size_t d = 0; d < diagrams && offsetsOk; ++d) {
+            VoronoiBuilder b;
+            b.build(sites.data() + offsets[d], offsets[d + 1] - offsets[d]);
+            std::size_t first = batch.segmentOffsets()[d];
+            offsetsOk = batch.segmentOffsets()[d + 1] - first == b.segments().size();
+            if (!offsetsOk) break;
+            for (std::size_t k = 0; k < b.segments().size(); ++k) {
+                const VoronoiBuilder::Seg &s = *b.segments()[k], &t = batch.segments()[first + k];
+                same = same && s.start == t.start && s.end == t.end && s.left == t.left && s.right == t.right;
+            }
+            const VoronoiBuilder::BoundingBox &x = batch.bounds(d), y = b.bounds();
+            same = same && x.X0 == y.X0 && x.X1 == y.X1 && x.Y0 == y.Y0 && x.Y1 == y.Y1;
+        }
+        ok = check(offsetsOk, "batch build: segment offsets of single builds") & ok;
+        ok = check(same, "batch build: the segments and boxes of single builds") & ok;
+    }
+    return ok;
+}
+
+// Whether d holds the diagram a fresh sweep gives for its sites: as many
+// sites and triangles, and the same neighbours for every site.
+static bool sameAsSweep(const DynamicVoronoi<double> &d) {
+    std::vector<int> ids;
+    std::vector<VoronoiBuilder::Point> sites;
+    for (std::size_t s = 0; s < d.idBound(); ++s)
+        if (d.contains(static_cast<int>(s))) {
+            ids.push_back(static_cast<int>(s));
+            sites.push_back(d.site(static_cast<int>(s)));
+        }
+    VoronoiBuilder b;
+    b.setTriangles(true);
+    b.build(sites);
+    if (ids.size() != d.size() || b.triangles().size() / 3 != d.triangleCount()) return false;
+    if (!d.triangleCount()) return true; // Collinear: no neighbours to compare.
+
+    // Sites whose cells share an edge of some length.
+    std::map<std::pair<int, int>, double> length;
+    for (const VoronoiBuilder::Seg *s : b.segments())
+        length[std::minmax(ids[s->left], ids[s->right])] +=
+                std::hypot(s->end.first - s->start.first, s->end.second - s->start.second);
+    std::vector<std::vector<int>> expected(d.idBound());
+    for (const auto &e : length)
+        if (e.second > 1e-9) {
+            expected[e.first.first].push_back(e.first.second);
+            expected[e.first.second].push_back(e.first.first);
+        }
+    std::vector<int> got;
+    for (int s : ids) {
+        d.neighbours(s, got);
+        std::sort(got.begin(), got.end());
+        std::sort(expected[s].begin(), expected[s].end());
+        if (got != expected[s]) return false;
+    }
+    return true;
+}
+
+// DynamicVoronoi must match a fresh sweep after any run of insertions and
+// removals: down to three sites and fewer, where it has no triangles, and
+// with sites put back where others were, or where others still are.
+static bool dynamicMatchesSweep() {
+    PointGenerator gen(6);
+    std::vector<DynamicVoronoi<double>::Point> sites = gen.generatePoints(400, 0, 100, 0, 100);
+    std::vector<DynamicVoronoi<double>::Point> more = gen.generatePoints(400, 0, 100, 0, 100);
+    DynamicVoronoi<double> d;
+    d.build(sites);
+    bool ok = check(sameAsSweep(d), "dynamic: the sweep after build");
+
+    bool updates = true, duplicates = true;
+    std::vector<DynamicVoronoi<double>::Point> removed;
+    for (int k = 0; k < 400; ++k) {
+        if (k % 3 == 2) {
+            int s = (k * 37) % static_cast<int>(d.idBound());
+            if (d.contains(s)) removed.push_back(d.site(s));
+            d.remove(s);
+        } else if (k % 5 == 1 && !removed.empty()) {
+            updates = updates && d.insert(removed.back()) >= 0;
+            removed.pop_back();
+        } else {
+            d.insert(more[k]);
+        }
+        int live = (k * 13) % static_cast<int>(d.idBound());
+        if (d.contains(live)) duplicates = duplicates && d.insert(d.site(live)) < 0;
+        if (k % 40 == 0) updates = updates && sameAsSweep(d);
+    }
+    ok = check(updates && sameAsSweep(d), "dynamic: the sweep after insertions and removals") & ok;
+    ok = check(duplicates, "dynamic: no second site where there is one") & ok;
+
+    // Down to nothing, then back up, by way of collinear sites.
+    bool small = true;
+    for (int s = 0; s < static_cast<int>(d.idBound()); ++s)
+        if (d.remove(s) && d.size() <= 4) small = small && sameAsSweep(d);
+    std::vector<DynamicVoronoi<double>::Point> back = {{1, 1}, {2, 2}, {3, 3}, {1, 1}, {2, 5}, {4, 4}, {2, 2}, {0, 7}};
+    for (const DynamicVoronoi<double>::Point &p : back) {
+        d.insert(p);
+        small = small && sameAsSweep(d);
+    }
+    ok = check(small && d.size() == 6, "dynamic: the sweep of three sites and fewer") & ok;
+    return ok;
+}
+
+int main() {
+    bool ok = true;
+    ok = floatMatchesDouble() && ok;
+    ok = leftColumnRays() && ok;
+    ok = parallelRaysMatch() && ok;
+    ok = cellsTileBox() && ok;
+    ok = tiledMatchesSweep() && ok;
+    ok = batchMatchesSingle() && ok;
+    ok = dynamicMatchesSweep() && ok;
+    std::cout << (ok ? "all passed" : "some failed") << '\n';
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}